@@ -0,0 +1,202 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <BirdLang.h>
+#include <Memory.h>
+
+#include "Workloads.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Measurement {
+	std::string name;
+	std::string stage;
+	unsigned long long iterations;
+	double ns_per_op;
+	double allocs_per_op;
+	double bytes_per_op;
+};
+
+// Runs `setup` untimed then `run` timed, until both the minimum number of
+// iterations and the minimum time are reached. Allocations made during
+// setup are not charged to the operation.
+template<typename Setup, typename Run>
+static Measurement measure(const std::string& name, const std::string& stage, double min_time, Setup setup, Run run)
+{
+	const unsigned long long min_iterations = 3;
+
+	setup();
+	run();
+
+	double elapsed = 0.0;
+	unsigned long long iterations = 0;
+	unsigned long long allocations = 0;
+	unsigned long long bytes = 0;
+
+	while (iterations < min_iterations || elapsed < min_time) {
+		setup();
+
+		auto before = Memory::counters();
+		auto start = Clock::now();
+
+		run();
+
+		auto end = Clock::now();
+		auto after = Memory::counters();
+
+		elapsed += std::chrono::duration<double>(end - start).count();
+		allocations += after.allocations - before.allocations;
+		bytes += after.bytes - before.bytes;
+		iterations++;
+	}
+
+	return Measurement{
+		name,
+		stage,
+		iterations,
+		elapsed / iterations * 1e9,
+		(double)allocations / iterations,
+		(double)bytes / iterations
+	};
+}
+
+static std::vector<std::string> expand(const Workload& workload, const std::string& scan_file)
+{
+	std::vector<std::string> lines;
+
+	for (auto line : workload.lines) {
+		auto position = line.find("$SCAN_FILE");
+
+		if (position != std::string::npos)
+			line.replace(position, strlen("$SCAN_FILE"), scan_file);
+
+		lines.push_back(line);
+	}
+
+	return lines;
+}
+
+static std::vector<Node*> parse(Compiler& compiler, const std::vector<std::string>& lines)
+{
+	std::vector<Node*> program;
+
+	for (size_t i = 0; i < lines.size(); ++i) {
+		compiler.parser->setTokens(compiler.lexer->index_tokens(lines[i], (int)i));
+		auto ast = compiler.parser->parse();
+
+		if (ast == nullptr || ast->error != nullptr) {
+			std::cerr << "Unable to parse: " << lines[i] << '\n';
+			exit(1);
+		}
+
+		program.push_back(ast->node);
+	}
+
+	return program;
+}
+
+static std::string createScanFile()
+{
+	auto path = (std::filesystem::temp_directory_path() / "birdlang-bench-scan.txt").string();
+	std::ofstream out(path, std::ios::out | std::ios::trunc);
+
+	for (int i = 0; i < 1000; ++i)
+		out << "line " << i << " of the benchmark scan file\n";
+
+	return path;
+}
+
+static void write(std::ostream& out, const std::vector<Measurement>& results)
+{
+	// Fixed key order and precision so two runs can be compared with diff.
+	out << std::fixed;
+	out << "{\n  \"format\": 1,\n  \"benchmarks\": [\n";
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		const auto& result = results[i];
+
+		out << "    {\"name\": \"" << result.name << "\", "
+			<< "\"stage\": \"" << result.stage << "\", "
+			<< "\"iterations\": " << result.iterations << ", "
+			<< std::setprecision(1) << "\"ns_per_op\": " << result.ns_per_op << ", "
+			<< std::setprecision(2) << "\"allocs_per_op\": " << result.allocs_per_op << ", "
+			<< std::setprecision(1) << "\"bytes_per_op\": " << result.bytes_per_op << "}"
+			<< (i + 1 < results.size() ? ",\n" : "\n");
+	}
+
+	out << "  ],\n  \"peak_rss_bytes\": " << Memory::peakResidentBytes() << "\n}\n";
+}
+
+int main(int argc, char** argv) {
+	double min_time = 0.2;
+	std::string filter;
+	std::string output;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+			min_time = atof(argv[++i]) / 1000.0;
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+			output = argv[++i];
+		else {
+			std::cerr << "usage: benchmarks [--filter name] [--min-time ms] [--out file]\n";
+			return 1;
+		}
+	}
+
+	auto scan_file = createScanFile();
+	std::vector<Measurement> results;
+
+	for (const auto& workload : workloads) {
+		if (!filter.empty() && std::string(workload.name).find(filter) == std::string::npos)
+			continue;
+
+		auto lines = expand(workload, scan_file);
+		Compiler compiler;
+
+		results.push_back(measure(workload.name, "lex", min_time, []() {}, [&]() {
+			for (size_t i = 0; i < lines.size(); ++i)
+				compiler.lexer->index_tokens(lines[i], (int)i);
+		}));
+
+		std::vector<std::vector<Token*>> tokens(lines.size());
+
+		results.push_back(measure(workload.name, "parse", min_time, [&]() {
+			for (size_t i = 0; i < lines.size(); ++i)
+				tokens[i] = compiler.lexer->index_tokens(lines[i], (int)i);
+		}, [&]() {
+			for (auto& line : tokens) {
+				compiler.parser->setTokens(line);
+				compiler.parser->parse();
+			}
+		}));
+
+		auto program = parse(compiler, lines);
+
+		results.push_back(measure(workload.name, "eval", min_time, []() {}, [&]() {
+			for (auto node : program)
+				compiler.evaluate(node);
+		}));
+
+		std::cerr << workload.name << " done\n";
+	}
+
+	if (output.empty()) {
+		write(std::cout, results);
+	}
+	else {
+		std::ofstream out(output, std::ios::out | std::ios::trunc);
+		write(out, results);
+	}
+
+	std::filesystem::remove(scan_file);
+
+	return 0;
+}
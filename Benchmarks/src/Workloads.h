@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Fixed corpus, keep the sources stable so results stay comparable
+// between builds. "$SCAN_FILE" is replaced by a generated data file.
+struct Workload {
+	const char* name;
+	std::vector<std::string> lines;
+};
+
+static const std::vector<Workload> workloads = {
+	{ "fib", {
+		"function fib(n) -> if n < 2 then n else fib(n - 1) + fib(n - 2)",
+		"var result = fib(15)"
+	}},
+	{ "nested_loops", {
+		"var acc = 0",
+		"for i = 0 to 100 then for j = 0 to 100 then var acc = acc + i * j"
+	}},
+	{ "string_building", {
+		"var s = \"\"",
+		"for i = 0 to 1000 then var s = s + \"x\""
+	}},
+	{ "string_join", {
+		"var parts = []",
+		"for i = 0 to 500 then var parts = parts < i",
+		"var s = join(parts, \", \")"
+	}},
+	{ "array_push_index", {
+		"var arr = []",
+		"for i = 0 to 500 then var arr = arr < i",
+		"var sum = 0",
+		"for i = 0 to 500 then var sum = sum + arr[i]"
+	}},
+	{ "array_build_10k", {
+		"var arr = []",
+		"for i = 0 to 10000 then var arr = arr < i"
+	}},
+	{ "array_build_100k", {
+		"var arr = []",
+		"for i = 0 to 100000 then var arr = arr < i"
+	}},
+	{ "array_natives", {
+		"var arr = []",
+		"for i = 0 to 1000 then push(arr, i)",
+		"for i = 0 to 500 then insert(arr, 0, pop(arr))",
+		"extend(arr, [1, 2, 3])",
+		"for i = 0 to 500 then remove(arr, 0)"
+	}},
+	{ "numeric_kernels", {
+		"var xs = []",
+		"for i = 0 to 10000 then push(xs, i * 0.5)",
+		"var total = 0",
+		"for i = 0 to 100 then var total = total + sum(xs) + max(xs) + dot(xs, xs) + sum(vmul(xs, 2.0))"
+	}},
+	{ "map_lookup", {
+		"var m = {a: 1, b: 2, c: 3, d: 4, e: 5}",
+		"var sum = 0",
+		"for i = 0 to 1000 then var sum = sum + m[\"c\"]"
+	}},
+	{ "array_index_assign", {
+		"var arr = []",
+		"for i = 0 to 10000 then push(arr, i)",
+		"for i = 0 to 10000 then arr[i] = arr[i] * 2"
+	}},
+	{ "map_index_assign", {
+		"var m = {}",
+		"for i = 0 to 10000 then m[str(i)] = i",
+		"for i = 0 to 10000 then m[str(i)] = m[str(i)] + 1",
+		"var cfg = {db: {pool: {size: 0}}}",
+		"for i = 0 to 1000 then cfg.db.pool.size = i"
+	}},
+	{ "for_in", {
+		"var arr = list(range(100000))",
+		"var total = 0",
+		"for x in arr then var total = total + x",
+		"for i in range(100000) then var total = total - i"
+	}},
+	{ "generator_pipeline", {
+		"function evens(n) -> for i = 0 to n then if i % 2 == 0 then yield i",
+		"function squares(xs) -> for x in xs then yield x * x",
+		"var total = 0",
+		"for x in squares(evens(2000)) then var total = total + x"
+	}},
+	{ "property_path", {
+		"var cfg = {name: \"app\", db: {host: \"local\", pool: {min: 1, size: 8}}}",
+		"var total = 0",
+		"for i = 0 to 1000 then var total = total + cfg.db.pool.size"
+	}},
+	{ "quickened_arith", {
+		"var xs = list(range(100))",
+		"var acc = 0",
+		"for i = 0 to 10000 then var acc = acc + xs[i % 100] * 3 - 1"
+	}},
+	{ "call_sites", {
+		"function scale(x, k) -> x * k + 0.5",
+		"var s = 0",
+		"for i = 0 to 10000 then var s = s + scale(i, 2.5)"
+	}},
+	{ "file_scan", {
+		"var size = 0",
+		"for i = 0 to 50 then var size = size + sizeof(open(\"$SCAN_FILE\"))"
+	}},
+	{ "native_math", {
+		"var x = 0",
+		"for i = 1 to 1000 then var x = x + sqrt(i) + sin(i) * cos(i) + floor(i / 3) + abs(-i)"
+	}}
+};
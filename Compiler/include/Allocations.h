@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts objects and bytes created by the compiler pipeline, per runtime
+// class and per pipeline phase. Recorded from the constructors, so it
+// works without replacing the global allocator.
+class Allocations {
+public:
+	enum Phase {
+		LEX,
+		PARSE,
+		EVAL,
+		PHASES
+	};
+
+	// Node kinds follow Node::Type, starting at NODE.
+	enum Kind {
+		TOKEN,
+		RUNTIME_RESULT,
+		TYPE,
+		NUMBER,
+		STRING,
+		ARRAY,
+		MAP,
+		FILE,
+		FUNCTION,
+		NATIVE_FUNCTION,
+		OBJECT,
+		NODE,
+		KINDS = NODE + 21
+	};
+
+	struct Stat {
+		unsigned long long count;
+		unsigned long long bytes;
+	};
+
+	// Switches the current phase for the lifetime of the scope.
+	class Scope {
+	public:
+		Scope(Phase phase) : previous(Allocations::phase) { Allocations::phase = phase; }
+		~Scope() { Allocations::phase = previous; }
+
+	private:
+		Phase previous;
+	};
+
+	static inline void record(Kind kind, size_t size) {
+		Stat& stat = stats[phase][kind];
+		stat.count++;
+		stat.bytes += size;
+	}
+
+	// Moves the allocation recorded by the Type constructor to its subclass.
+	static inline void refine(Kind kind, size_t size) {
+		Stat& base = stats[phase][TYPE];
+		base.count--;
+		base.bytes -= type_size;
+		record(kind, size);
+	}
+
+	static void node(int type);
+	static void reset();
+	static const char* name(int kind);
+	static Stat total(int kind);
+
+	static Phase phase;
+	static Stat stats[PHASES][KINDS];
+	static const size_t type_size;
+};
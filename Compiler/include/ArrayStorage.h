@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+class Type;
+
+// Backing storage of an array value. Copies of the value share the same
+// elements, so pushes and removals through any of them are done in place
+// and seen by every holder instead of copying the whole vector.
+//
+// While an array only holds ints, or only doubles, the numbers are packed
+// in a flat vector instead of one boxed Number per element. The first
+// element of another kind switches the storage back to boxed for good.
+class ArrayStorage {
+public:
+	enum Kind {
+		BOXED,
+		INTS,
+		DOUBLES
+	};
+
+	ArrayStorage();
+	ArrayStorage(const std::vector<Type*>& elements);
+	ArrayStorage(std::vector<int>&& ints);
+	ArrayStorage(std::vector<double>&& doubles);
+
+	Kind kind() const { return storage->kind; }
+	size_t size() const;
+	bool empty() const { return size() == 0; }
+
+	// Packed elements are boxed into a fresh Number on every read.
+	Type* at(size_t index) const;
+	void push(Type* element);
+	void insert(size_t index, Type* element);
+	// Replaces an element in place, packed storage stays packed when the
+	// new element is of the same kind.
+	void set(size_t index, Type* element);
+	Type* remove(size_t index);
+	void erase(size_t index);
+	void extend(const ArrayStorage& other);
+
+	// Boxed snapshot of the elements, the storage itself is left packed.
+	std::vector<Type*> elements() const;
+	// Direct access to the boxed elements, unpacking the storage first.
+	std::vector<Type*>& boxed() const;
+
+	const std::vector<int>& ints() const { return storage->ints; }
+	const std::vector<double>& doubles() const { return storage->doubles; }
+
+	bool shares(const ArrayStorage& other) const { return storage == other.storage; }
+
+	friend bool operator==(const ArrayStorage& a, const ArrayStorage& b);
+	friend bool operator!=(const ArrayStorage& a, const ArrayStorage& b) { return !(a == b); }
+	friend bool operator<(const ArrayStorage& a, const ArrayStorage& b) { return a.size() < b.size(); }
+	friend bool operator>(const ArrayStorage& a, const ArrayStorage& b) { return a.size() > b.size(); }
+	friend bool operator<=(const ArrayStorage& a, const ArrayStorage& b) { return a.size() <= b.size(); }
+	friend bool operator>=(const ArrayStorage& a, const ArrayStorage& b) { return a.size() >= b.size(); }
+
+private:
+	struct Storage {
+		Kind kind = BOXED;
+		std::vector<Type*> boxed;
+		std::vector<int> ints;
+		std::vector<double> doubles;
+	};
+
+	// Makes room for `element` in the current representation: an empty
+	// array adopts the kind of its first number, a mismatch unpacks.
+	void prepare(Type* element);
+	void unpack() const;
+
+	std::shared_ptr<Storage> storage;
+};
@@ -31,10 +31,13 @@ public:
 		Context* ctx
 	);
 
+	static std::string optional_name(const std::string& name);
+
 	RuntimeResult* check_and_populate_arguments(
 		const std::vector<std::string>& names,
 		const std::vector<Type*>& args,
-		Context* ctx
+		Context* ctx,
+		bool checked = false
 	);
 
 	std::string name;
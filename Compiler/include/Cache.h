@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Nodes.h"
+#include "Platform.h"
+
+class Cache {
+public:
+	static const uint32_t magic;
+	static const uint32_t version;
+
+	Cache(const std::string& directory = "");
+
+	static uint64_t hash(const std::string& source);
+
+	std::string path(uint64_t key);
+	bool load(uint64_t key, const std::string& filename, std::vector<Node*>& program);
+	bool store(uint64_t key, const std::vector<Node*>& program);
+
+	std::string directory;
+	unsigned int hits;
+	unsigned int misses;
+	double loading_time;
+};
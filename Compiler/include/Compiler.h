@@ -2,6 +2,7 @@
 
 #include <string>
 #include <memory>
+#include <chrono>
 
 #include "Token.h"
 #include "Lexer.h"
@@ -10,17 +11,42 @@
 #include "Context.h"
 #include "Symbols.h"
 #include "Platform.h"
+#include "Cache.h"
+#include "Optimizer.h"
 
 class Compiler {
 public:
 	Compiler(
 		bool debug_lexer = false,
 		bool debug_parser = false,
-		bool profiling = false
+		bool profiling = false,
+		bool caching = false,
+		bool startup_stats = false
 	);
 
+	bool resolve(const std::string& name, DynamicType& value);
+	// Replaces the global scope with an empty one, builtins are resolved anew.
+	void resetGlobals();
+
 	void interpret(const std::string& input);
+	void interpretFile(const std::string& filename);
+	// Runs an already parsed program, returns false if a statement failed.
+	bool run(const std::vector<Node*>& program, const std::string& source = "");
+	bool compileToExecutable(const std::string& filename, const std::string& output);
+	bool compileFile(const std::string& filename, std::string& source, std::vector<Node*>& program);
+	void benchmarkFile(const std::string& filename, unsigned int runs, unsigned int warmup, bool json = false);
+	RuntimeResult* evaluate(Node* node);
+	void report(RuntimeResult* result, bool echo = true);
 	void printStatistics();
+	void printStartupStatistics();
+	void enableTracing(const std::string& path);
+	void enableSampling(const std::string& path);
+	void enableInstrumentation();
+	void enableOptimizations();
+	void printInstrumentation(const std::string& source);
+	void writeSamples();
+	void enableMetrics(const std::string& path);
+	void writeMetrics();
 
 	Context* context;
 	Symbols* symbols;
@@ -28,10 +54,23 @@ public:
 	std::unique_ptr<Lexer> lexer;
 	std::unique_ptr<Parser> parser;
 	std::unique_ptr<Interpreter> interpreter;
+	std::unique_ptr<Cache> cache;
+	// Set by enableOptimizations(), files are optimized before running.
+	std::unique_ptr<Optimizer> optimizer;
 
 	bool debug_lexer;
 	bool debug_parser;
 	bool profiling;
+	bool caching;
+	bool startup_stats;
+	std::string trace_path;
+	std::string samples_path;
+	std::string metrics_path;
 
 	double interpreting_time;
+	unsigned int builtins_materialized;
+
+	std::chrono::steady_clock::time_point launched;
+	std::chrono::steady_clock::time_point constructed;
+	std::chrono::steady_clock::time_point first_evaluation;
 };
@@ -6,6 +6,9 @@
 #include "Symbols.h"
 #include "Platform.h"
 
+class Coroutine;
+class Closure;
+
 class Context {
 public:
 	Context(
@@ -20,4 +23,8 @@ public:
 	Context* parent;
 	std::shared_ptr<Cursor> parent_cursor;
 	Symbols* symbols;
+	// Set on the scope of a running generator call, `yield` suspends it.
+	Coroutine* coroutine;
+	// Captured variables of the function this scope is a call of.
+	Closure* closure;
 };
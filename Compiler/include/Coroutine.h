@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class Type;
+class Error;
+
+// Suspendable body of a generator function. The body runs on its own
+// thread but strictly alternates with its consumer, exactly one side runs
+// at any time, so the interpreter state is never touched concurrently.
+// The thread is only started by the first resume().
+class Coroutine {
+public:
+	// Thrown out of yield() when the coroutine is destroyed while the body
+	// is suspended, it unwinds the body's frames.
+	struct Cancelled {};
+
+	Coroutine(std::function<Error*(Coroutine&)> body);
+	~Coroutine();
+
+	// Runs the body until its next yield. Returns false once it finished,
+	// in which case error() holds what it failed with, if anything.
+	bool resume();
+	// Called from the body, hands `value` to the consumer and suspends.
+	void yield(Type* value);
+
+	Type* value() const { return current; }
+	Error* error() const { return failure; }
+	bool done() const { return finished; }
+
+private:
+	// Blocks the calling side until it is its turn again.
+	void wait(std::unique_lock<std::mutex>& lock, bool body);
+
+	std::function<Error*(Coroutine&)> body;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable turn;
+	bool running;
+	bool started;
+	bool finished;
+	bool cancelled;
+	Type* current;
+	Error* failure;
+};
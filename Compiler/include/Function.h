@@ -8,6 +8,23 @@
 #include "Interpreter.h"
 #include "Type.h"
 #include "BaseFunction.h"
+#include "Jit.h"
+
+class Coroutine;
+
+// Free variables of a function defined inside a call. They are copied out
+// of the enclosing call scopes when the function is defined, so it can
+// outlive them. Globals are not copied, they stay live through the parent
+// of `symbols`.
+class Closure {
+public:
+	Closure(Symbols* globals);
+	~Closure();
+
+	Symbols* symbols;
+	// By capture slot, null for names that were not found when defined.
+	std::vector<DynamicType*> slots;
+};
 
 class Function : public BaseFunction {
 public:
@@ -17,12 +34,21 @@ public:
 		const std::vector<std::string>& args_names,
 		std::shared_ptr<Cursor> start = nullptr,
 		std::shared_ptr<Cursor> end = nullptr,
-		Context* context = nullptr
+		Context* context = nullptr,
+		bool generator = false
 	);
 
-	RuntimeResult* execute(const std::vector<Type*>& args, Context* context) override;
+	RuntimeResult* execute(const std::vector<Type*>& args, Context* context, bool checked = false) override;
+	std::shared_ptr<Coroutine> start_generator(Context* scope);
+	// Where the body's free variables are found: the closure, or the
+	// global scope for functions defined at the top level.
+	Symbols* environment() const;
 
 	std::string name;
 	Node* body;
 	std::vector<std::string> args_names;
+	// Calls return a lazy stream running the body as a coroutine.
+	bool generator;
+	std::shared_ptr<Closure> closure;
+	Hotness hotness;
 };
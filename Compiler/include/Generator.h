@@ -1,6 +1,52 @@
 #pragma once
 
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Nodes.h"
+
+// Ahead-of-time compiler. Emits a C++ translation unit that rebuilds the
+// parsed program with the node constructors and runs it against the
+// Compiler static library, then builds it with the system compiler. The
+// executable starts straight at evaluation, without lexing or parsing.
+//
+// Loops and functions in the int subset the JIT covers are also emitted
+// as C++ functions following the JitCode calling convention. They are
+// installed as the node's compiled code, so they run natively from their
+// first execution behind the same type checks, and fall back to the
+// interpreter like JIT code does.
 class Generator {
 public:
 	Generator();
+
+	// Returns false when the program holds a node it cannot emit.
+	bool emit(const std::vector<Node*>& program, const std::string& filename, std::string& source);
+	// Builds `source` into `output` through a temporary `output`.cpp, kept
+	// only when the build fails.
+	bool build(const std::string& source, const std::string& output);
+
+	// Taken from CXX, BIRD_INCLUDE and BIRD_LIBRARY when they are set, the
+	// headers and library default to their place in the build tree
+	// relative to the running executable.
+	std::string compiler;
+	std::string include_directory;
+	std::string library;
+	// The last build command, for error reports.
+	std::string command;
+	// Loops and functions the last emit() compiled to C++.
+	unsigned int compiled;
+
+private:
+	bool node(Node* node, std::string& out);
+	std::string precompile(ForStatementNode* loop);
+	std::string precompile(FunctionDefinitionNode* function);
+
+	// C++ of the precompiled loops and functions.
+	std::string natives;
+	std::string token(Token* token);
+	std::string cursor(std::shared_ptr<Cursor> cursor);
+	std::string tokens(const std::vector<Token*>& tokens);
+
+	static std::string quote(const std::string& value);
 };
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "Nodes.h"
+
+// Exact per-line and per-node-kind execution counts with self time,
+// collected around every Interpreter::visit while enabled.
+class Instrumentation {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Stat {
+		unsigned long long hits;
+		double self;
+	};
+
+	// Times one node visit, time spent in nested visits is charged to them.
+	class Visit {
+	public:
+		Visit(Node* node);
+		~Visit();
+
+		Visit(const Visit&) = delete;
+		Visit& operator=(const Visit&) = delete;
+
+	private:
+		Node* node;
+		int line;
+		int previous;
+		Clock::time_point start;
+	};
+
+	static void reset();
+	static double total();
+
+	static bool enabled;
+	static int current;
+	static std::vector<Stat> lines;
+	static Stat types[Node::Type::INDUCTION + 1];
+	static std::vector<double> children;
+};
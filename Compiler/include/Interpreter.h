@@ -6,10 +6,13 @@
 #include "Error.h"
 #include "Context.h"
 #include "Platform.h"
+#include "Allocations.h"
 
 class RuntimeResult {
 public:
-	RuntimeResult() = default;
+	RuntimeResult() {
+		Allocations::record(Allocations::Kind::RUNTIME_RESULT, sizeof(RuntimeResult));
+	}
 
 	Type* record(RuntimeResult* result) {
 		if (result->error != nullptr) {
@@ -38,13 +41,16 @@ public:
 	Interpreter();
 	
 	RuntimeResult* visit(Node* node, Context* context);
+	RuntimeResult* dispatch(Node* node, Context* context);
 	RuntimeResult* visit_numeric_node(Node* node, Context* context);
 	RuntimeResult* visit_binary_operation_node(Node* node, Context* context);
 	RuntimeResult* visit_unary_operation_node(Node* node, Context* context);
 	RuntimeResult* visit_variable_access_node(Node* node, Context* context);
 	RuntimeResult* visit_variable_assignment_node(Node* node, Context* context);
+	RuntimeResult* visit_string_append(Node* node, Context* context);
 	RuntimeResult* visit_if_statement_node(Node* node, Context* context);
 	RuntimeResult* visit_for_statement_node(Node* node, Context* context);
+	RuntimeResult* visit_for_in_statement_node(Node* node, Context* context);
 	RuntimeResult* visit_while_statement_node(Node* node, Context* context);
 	RuntimeResult* visit_function_definition_node(Node* node, Context* context);
 	RuntimeResult* visit_function_call_node(Node* node, Context* context);
@@ -52,12 +58,24 @@ public:
 	RuntimeResult* visit_array_node(Node* node, Context* context);
 	RuntimeResult* visit_property_access_node(Node* node, Context* context);
 	RuntimeResult* visit_index_access_node(Node* node, Context* context);
+	RuntimeResult* visit_property_assignment_node(Node* node, Context* context);
+	RuntimeResult* visit_index_assignment_node(Node* node, Context* context);
+	RuntimeResult* visit_yield_node(Node* node, Context* context);
 	RuntimeResult* visit_map_node(Node* node, Context* context);
+	RuntimeResult* visit_invariant_node(Node* node, Context* context);
+	RuntimeResult* visit_induction_node(Node* node, Context* context);
+
+	// Evaluates int literals, int variables, and int-quickened operations
+	// and index accesses over them straight to an int, nothing is boxed.
+	// Returns false for anything else, the node is then visited normally.
+	bool unboxed_int(Node* node, Context* context, int& value);
 
-	Type* find_map_recursive(
-		const std::string& needle,
-		Context* context,
-		const std::vector<Token*>& path,
-		const std::map<std::string, Type*>& object
+	// Follows the first `count` steps of a property path from `root`,
+	// refreshing each step's inline cache on the way.
+	RuntimeResult* follow_property_path(
+		PropertyAccessNode* node,
+		const MapStorage& root,
+		size_t count,
+		Context* context
 	);
 };
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Function;
+class ForStatementNode;
+class Symbols;
+class Type;
+
+// Machine code compiled from one loop or function. Variables live in a
+// frame of 64-bit slots, only the low 32 bits are used since compiled code
+// only ever handles ints. Hidden slots (empty name) hold loop counters.
+class JitCode {
+public:
+	using Entry = int(*)(int64_t* slots);
+
+	JitCode(const std::vector<uint8_t>& bytes);
+	// Code compiled ahead of time into the executable, nothing is mapped.
+	JitCode(Entry entry);
+	~JitCode();
+
+	bool valid() const { return entry != nullptr; }
+
+	Entry entry;
+	size_t size;
+
+	std::vector<std::string> names;
+	// Names written by the code, they are copied back into the scope.
+	std::vector<bool> assigned;
+	// Loop variable, counter and end slots of a compiled loop.
+	unsigned int variable;
+	unsigned int counter;
+	unsigned int end;
+	// A function calling itself by name, the name is checked on entry.
+	bool recursive;
+};
+
+// Per loop or function counters deciding when to compile.
+struct Hotness {
+	unsigned int count = 0;
+	unsigned int failures = 0;
+	bool rejected = false;
+	std::shared_ptr<JitCode> code;
+};
+
+// Baseline template compiler to x86-64. It only covers int arithmetic:
+// int literals, variables, + - * and unary minus, comparisons as `if`
+// conditions, `var` assignments, `if` and numeric `for` loops with a
+// constant step, and functions of int arguments calling themselves.
+// Anything else is rejected once and stays interpreted.
+//
+// Types are checked on entry only, the covered subset cannot change a
+// variable's type. A failed check deoptimizes that one execution back to
+// the interpreter, repeated failures drop the code for good.
+class Jit {
+public:
+	static constexpr unsigned int LOOP_THRESHOLD = 1000;
+	static constexpr unsigned int CALL_THRESHOLD = 100;
+	static constexpr unsigned int MAX_FAILURES = 3;
+
+	static bool enabled;
+
+	// False on targets without a code generator, everything is interpreted.
+	static bool supported();
+
+	static JitCode* compile(ForStatementNode* loop);
+	static JitCode* compile(Function* function);
+
+	// Called before every iteration of a numeric `for`, with the value the
+	// loop variable is about to take. Once the loop is hot, runs all the
+	// remaining iterations natively and returns true.
+	static bool enter(ForStatementNode* loop, Symbols* scope, int increment, int end);
+	// Called on every call of `function`, returns true with the result in
+	// `value` when the call ran natively.
+	static bool execute(Function* function, const std::vector<Type*>& args, int& value);
+
+private:
+	static bool reject(Hotness& hotness);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+// Loops over packed array storage used by the numeric natives. Each kernel
+// has an SSE2 path on x86 and a scalar fallback everywhere else.
+class Kernels {
+public:
+	enum Operation {
+		ADD,
+		SUBTRACT,
+		MULTIPLY,
+		DIVIDE
+	};
+
+	static long long sum(const int* data, size_t size);
+	static double sum(const double* data, size_t size);
+
+	static int min(const int* data, size_t size);
+	static double min(const double* data, size_t size);
+	static int max(const int* data, size_t size);
+	static double max(const double* data, size_t size);
+
+	static long long dot(const int* a, const int* b, size_t size);
+	static double dot(const double* a, const double* b, size_t size);
+
+	// `out[i] = a[i] op b[i]`, or `a[i] op scalar` when b is null. Integer
+	// DIVIDE truncates and yields 0 for a zero divisor. Returns false when
+	// an integer result does not fit in an int, `out` is then incomplete.
+	static bool apply(Operation operation, const int* a, const int* b, int scalar, int* out, size_t size);
+	static void apply(Operation operation, const double* a, const double* b, double scalar, double* out, size_t size);
+};
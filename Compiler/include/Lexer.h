@@ -12,7 +12,7 @@ public:
 	
 	void advance();
 	void create_token(const Token::Type& type, char value = '\0');
-	std::vector<Token*> index_tokens(const std::string& str);
+	std::vector<Token*> index_tokens(const std::string& str, int line = 0);
 	Token* create_numeric_token();
 	Token* create_identifier();
 	Token* create_equals_operator();
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Type;
+
+// Backing storage of a map value, shared between copies like ArrayStorage.
+// Entries live in a dense vector in insertion order, an open-addressing
+// table of entry indices with linear probing finds them by key. Each entry
+// keeps its key's hash so probes only compare strings on a hash match.
+class MapStorage {
+public:
+	struct Entry {
+		std::string key;
+		size_t hash;
+		Type* value;
+	};
+
+	static constexpr size_t NPOS = (size_t)-1;
+
+	MapStorage();
+
+	size_t size() const { return storage->entries.size(); }
+	bool empty() const { return storage->entries.empty(); }
+	const std::vector<Entry>& entries() const { return storage->entries; }
+
+	// Returns nullptr when the key is missing. Callers looking up the same
+	// constant key repeatedly can pass its precomputed hash.
+	Type* find(std::string_view key) const;
+	Type* find(std::string_view key, size_t hash) const;
+
+	// Index of the key's entry, or NPOS. Entries are never removed or
+	// reordered, so an index stays valid for as long as the storage with
+	// this shape() lives.
+	size_t indexOf(std::string_view key, size_t hash) const;
+	Type* at(size_t index) const { return storage->entries[index].value; }
+
+	// Unique per storage and never reused, unlike its address.
+	uint64_t shape() const { return storage->shape; }
+
+	// Inserts at the end, or replaces the value in place for a known key.
+	void set(std::string_view key, Type* value);
+	void set(std::string_view key, size_t hash, Type* value);
+
+	bool shares(const MapStorage& other) const { return storage == other.storage; }
+
+	static size_t hash(std::string_view key);
+
+	friend bool operator==(const MapStorage& a, const MapStorage& b);
+	friend bool operator!=(const MapStorage& a, const MapStorage& b) { return !(a == b); }
+	friend bool operator<(const MapStorage& a, const MapStorage& b) { return a.size() < b.size(); }
+	friend bool operator>(const MapStorage& a, const MapStorage& b) { return a.size() > b.size(); }
+	friend bool operator<=(const MapStorage& a, const MapStorage& b) { return a.size() <= b.size(); }
+	friend bool operator>=(const MapStorage& a, const MapStorage& b) { return a.size() >= b.size(); }
+
+private:
+	static constexpr unsigned int EMPTY = 0xFFFFFFFF;
+
+	struct Storage {
+		uint64_t shape;
+		std::vector<Entry> entries;
+		std::vector<unsigned int> slots;
+	};
+
+	// Slot holding `key`, or the empty slot where it would be inserted.
+	size_t probe(std::string_view key, size_t hash) const;
+	void grow();
+
+	std::shared_ptr<Storage> storage;
+};
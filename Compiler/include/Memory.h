@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+// Process-wide allocation counters. Linking Memory.cpp replaces the global
+// operator new/delete, so only binaries that reference Memory pay for it.
+class Memory {
+public:
+	struct Counters {
+		unsigned long long allocations;
+		unsigned long long bytes;
+		unsigned long long live;
+	};
+
+	static Counters counters();
+	static size_t peakResidentBytes();
+};
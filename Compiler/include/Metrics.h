@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+
+// In-process registry of runtime metrics, for hosts that embed the
+// interpreter and need to scrape it. Counters and histograms are returned
+// by reference and stay valid for the lifetime of the process, so hot
+// paths resolve them once and only increment afterwards.
+class Metrics {
+public:
+	enum Format {
+		JSON,
+		PROMETHEUS
+	};
+
+	class Histogram {
+	public:
+		Histogram(const std::vector<double>& bounds = latency_bounds);
+
+		void observe(double value);
+
+		std::vector<double> bounds;
+		std::vector<unsigned long long> buckets;
+		double sum;
+		unsigned long long count;
+	};
+
+	// Metrics sharing a name, one series per label value.
+	struct Family {
+		std::string help;
+		std::string label;
+		bool histogram;
+		std::map<std::string, unsigned long long> counters;
+		std::map<std::string, Histogram> histograms;
+	};
+
+	static unsigned long long& counter(
+		const std::string& name,
+		const std::string& help,
+		const std::string& label = "",
+		const std::string& value = ""
+	);
+
+	static Histogram& histogram(
+		const std::string& name,
+		const std::string& help,
+		const std::string& label = "",
+		const std::string& value = ""
+	);
+
+	static void countError(const std::string& kind);
+	static void observePhase(const std::string& phase, double seconds);
+
+	static std::string render(Format format);
+	static bool dump(const std::string& path, Format format);
+	static void dump(const std::function<void(const std::string&)>& callback, Format format);
+	static void reset();
+
+	static const std::vector<double> latency_bounds;
+	static std::map<std::string, Family> families;
+};
@@ -5,8 +5,15 @@
 
 class NativeFunction : public BaseFunction {
 public:
-	using NativeFunctionPtr = std::function<RuntimeResult*(Context*)>;
-	typedef std::unordered_map<std::string, std::pair<std::vector<std::string>, NativeFunctionPtr>> NativeFunctionList;
+	typedef RuntimeResult* (*NativeFunctionPtr)(Context*);
+
+	// Plain aggregate so the table is constant-initialized and costs
+	// nothing at startup, builtins are only instantiated on first lookup.
+	struct Entry {
+		const char* name;
+		const char* args_names[3];
+		NativeFunctionPtr function;
+	};
 
 	NativeFunction(
 		const std::string& name,
@@ -14,18 +21,39 @@ public:
 		const std::vector<std::string>& args_names,
 		std::shared_ptr<Cursor> start = nullptr,
 		std::shared_ptr<Cursor> end = nullptr,
-		Context* context = nullptr
+		Context* context = nullptr,
+		NativeFunctionPtr function = nullptr
 	);
 
-	RuntimeResult* execute(const std::vector<Type*>& args, Context* context) override;
+	RuntimeResult* execute(const std::vector<Type*>& args, Context* context, bool checked = false) override;
+
+	static const Entry* find(const std::string& name);
+	static NativeFunction* create(const std::string& name);
 
 	static RuntimeResult* fn_str(Context* ctx);
+	static RuntimeResult* fn_join(Context* ctx);
 	static RuntimeResult* fn_bool(Context* ctx);
 	static RuntimeResult* fn_int(Context* ctx);
 	static RuntimeResult* fn_float(Context* ctx);
 
 	static RuntimeResult* fn_keys(Context* ctx);
 	static RuntimeResult* fn_values(Context* ctx);
+	static RuntimeResult* fn_chars(Context* ctx);
+	static RuntimeResult* fn_range(Context* ctx);
+	static RuntimeResult* fn_list(Context* ctx);
+	static RuntimeResult* fn_push(Context* ctx);
+	static RuntimeResult* fn_pop(Context* ctx);
+	static RuntimeResult* fn_insert(Context* ctx);
+	static RuntimeResult* fn_remove(Context* ctx);
+	static RuntimeResult* fn_extend(Context* ctx);
+
+	static RuntimeResult* fn_sum(Context* ctx);
+	static RuntimeResult* fn_mean(Context* ctx);
+	static RuntimeResult* fn_dot(Context* ctx);
+	static RuntimeResult* fn_vadd(Context* ctx);
+	static RuntimeResult* fn_vsub(Context* ctx);
+	static RuntimeResult* fn_vmul(Context* ctx);
+	static RuntimeResult* fn_vdiv(Context* ctx);
 
 	static RuntimeResult* fn_print(Context* ctx);
 	static RuntimeResult* fn_sizeof(Context* ctx);
@@ -70,5 +98,9 @@ public:
 	static RuntimeResult* fn_tanh(Context* ctx);
 	static RuntimeResult* fn_trunc(Context* ctx);
 
-	static NativeFunctionList list;
+	static const Entry list[];
+	static const size_t list_size;
+
+	NativeFunctionPtr function;
+	unsigned long long* calls;
 };
@@ -2,6 +2,34 @@
 
 #include "Token.h"
 #include "Platform.h"
+#include "SharedString.h"
+#include "MapStorage.h"
+#include "Symbols.h"
+#include "Jit.h"
+
+// Type feedback of a node. It specializes on its first visit and falls
+// back to GENERIC for good once the guard of its specialization fails.
+// INT means two int operands for an operation, and an int index into a
+// packed int array for an index access.
+enum class Quickening : uint8_t {
+	UNSEEN,
+	INT,
+	GENERIC
+};
+
+class Function;
+class Closure;
+
+// Callee a call site resolved to last time. It stays valid as long as no
+// function was bound or unbound anywhere since (see Symbols::version) and
+// the call runs in the same closure, captured callees differ per closure.
+struct CallCache {
+	Function* function = nullptr;
+	Closure* closure = nullptr;
+	uint64_t version = 0;
+	// Argument count the callee already accepted, it is not checked again.
+	size_t arity = SIZE_MAX;
+};
 
 class Node {
 public:
@@ -23,7 +51,10 @@ public:
 		PROPERTY_ACCESS,
 		PROPERTY_ASSIGN,
 		INDEX_ACCESS,
-		INDEX_ASSIGN
+		INDEX_ASSIGN,
+		YIELD,
+		INVARIANT,
+		INDUCTION
 	};
 
 	Node(
@@ -39,8 +70,11 @@ public:
 		right(right),
 		type(type),
 		start(start),
-		end(end)
-	{}
+		end(end),
+		discarded(false)
+	{
+		Allocations::node(type);
+	}
 
 	virtual ~Node() {
 		delete token;
@@ -64,13 +98,32 @@ public:
 		case Type::FN_CALL:			return "FN_CALL";
 		case Type::STRING:			return "STRING";
 		case Type::ARRAY:			return "ARRAY";
+		case Type::MAP:				return "MAP";
 		case Type::PROPERTY_ACCESS: return "PROPERTY_ACCESS";
 		case Type::PROPERTY_ASSIGN: return "PROPERTY_ASSIGN";
 		case Type::INDEX_ACCESS:	return "INDEX_ACCESS";
 		case Type::INDEX_ASSIGN:	return "INDEX_ASSIGN";
+		case Type::YIELD:			return "YIELD";
+		case Type::INVARIANT:		return "INVARIANT";
+		case Type::INDUCTION:		return "INDUCTION";
 		}
 	}
 
+	// Source line the node was parsed from, or -1 when it is unknown.
+	inline int line() {
+		if (start != nullptr)
+			return start->line;
+
+		if (token != nullptr && token->start != nullptr)
+			return token->start->line;
+
+		return -1;
+	}
+
+	// Marks a node whose value is never read, such as a loop body, so its
+	// visit is allowed to skip building a result.
+	static void discard(Node* node);
+
 	friend std::ostream& operator << (std::ostream& stream, Node* node);
 
 	Token* token;
@@ -79,6 +132,7 @@ public:
 	Type type;
 	std::shared_ptr<Cursor> start;
 	std::shared_ptr<Cursor> end;
+	bool discarded;
 };
 
 class NumericNode : public Node {
@@ -91,15 +145,24 @@ public:
 class StringNode : public Node {
 public:
 	StringNode(Token* token) :
-		Node(token, nullptr, nullptr, Type::STRING)
+		Node(token, nullptr, nullptr, Type::STRING),
+		value(SharedString::intern(std::get<std::string>(token->value))),
+		hash(MapStorage::hash(value))
 	{}
+
+	SharedString value;
+	// Precomputed for map lookups keyed by this literal.
+	size_t hash;
 };
 
 class BinaryOperationNode : public Node {
 public:
 	BinaryOperationNode(Node* left, Token* token, Node* right) :
-		Node(token, left, right, Type::BINARY)
+		Node(token, left, right, Type::BINARY),
+		quickening(Quickening::UNSEEN)
 	{}
+
+	Quickening quickening;
 };
 
 class UnaryOperationNode : public Node {
@@ -122,8 +185,13 @@ public:
 			Type::VARIABLE_ACCESS,
 			token->start,
 			token->end
-		)
+		),
+		capture(-1)
 	{}
+
+	// Slot in the closure of the enclosing function, -1 when the name is
+	// not one of its captures.
+	int capture;
 };
 
 class VariableAssignmentNode : public Node {
@@ -160,6 +228,40 @@ public:
 	Node* else_case;
 };
 
+// Loop invariant expression hoisted by the optimizer. Its value is
+// computed on the first visit of every run of the loop, and reused by
+// the later iterations. Only numbers are kept, anything else is computed
+// again on each visit.
+class InvariantNode : public Node {
+public:
+	InvariantNode(Node* value) :
+		Node(new Token(value->token), value, nullptr, Type::INVARIANT, value->start, value->end),
+		cached(false)
+	{}
+
+	bool cached;
+	DynamicType value;
+};
+
+// `i * n` or `n * i` in a numeric loop over `i`, n an int literal. The
+// loop sets the product when it starts and adds step * n every iteration
+// instead of multiplying. `left` keeps the multiplication.
+class InductionNode : public Node {
+public:
+	InductionNode(Node* product, int factor) :
+		Node(new Token(product->token), product, nullptr, Type::INDUCTION, product->start, product->end),
+		factor(factor),
+		value(0),
+		delta(0)
+	{}
+
+	int factor;
+	int value;
+	int delta;
+};
+
+// `for i = start to end step n`, or `for x in iterable` in which case
+// start_value is the iterable and end_value and step are null.
 class ForStatementNode : public Node {
 public:
 	ForStatementNode(
@@ -181,12 +283,19 @@ public:
 		end_value(end_value),
 		step(step),
 		body(body)
-	{}
+	{
+		discard(body);
+	}
 
 	Node* start_value;
 	Node* end_value;
 	Node* step;
 	Node* body;
+	// Iterations run so far, numeric loops are compiled once hot.
+	Hotness hotness;
+	// Set by the optimizer, reset every time the loop starts.
+	std::vector<InvariantNode*> invariants;
+	std::vector<InductionNode*> inductions;
 };
 
 class WhileStatementNode : public Node {
@@ -202,7 +311,9 @@ public:
 		),
 		condition(condition),
 		body(body)
-	{}
+	{
+		discard(body);
+	}
 
 	~WhileStatementNode() {
 		delete condition;
@@ -211,6 +322,8 @@ public:
 
 	Node* condition;
 	Node* body;
+	// Set by the optimizer, reset every time the loop starts.
+	std::vector<InvariantNode*> invariants;
 };
 
 class FunctionDefinitionNode : public Node {
@@ -218,11 +331,14 @@ public:
 	FunctionDefinitionNode(
 		const std::vector<Token*>& args_names,
 		Node* body,
-		Token* token = nullptr
+		Token* token = nullptr,
+		bool generator = false
 	) :
 		Node(token, nullptr, nullptr, Type::FN_DEFINITION),
 		args_names(args_names),
-		body(body)
+		body(body),
+		generator(generator),
+		resolved(false)
 	{
 		if (token != nullptr)
 			start = token->start;
@@ -236,12 +352,28 @@ public:
 
 	std::vector<Token*> args_names;
 	Node* body;
+	// The body yields, calling the function returns a lazy stream.
+	bool generator;
+	// Free names of the body, nested functions included, in slot order.
+	// Computed the first time the definition is visited.
+	std::vector<std::string> captures;
+	bool resolved;
+	// Native code built ahead of time, given to every function defined
+	// from this node.
+	std::shared_ptr<JitCode> precompiled;
 
 	~FunctionDefinitionNode() {
 		delete body;
 	}
 };
 
+class YieldNode : public Node {
+public:
+	YieldNode(Token* token, Node* value) :
+		Node(token, value, nullptr, Type::YIELD, token->start, token->end)
+	{}
+};
+
 class FunctionCallNode : public Node {
 public:
 	FunctionCallNode(
@@ -265,6 +397,7 @@ public:
 
 	Node* callee;
 	std::vector<Node*> args_nodes;
+	CallCache cache;
 };
 
 class ArrayNode : public Node {
@@ -279,12 +412,13 @@ public:
 
 class MapNode : public Node {
 public:
-	MapNode(Token* token, const std::map<std::string, Node*>& elements) :
+	MapNode(Token* token, const std::vector<std::pair<std::string, Node*>>& elements) :
 		Node(token, nullptr, nullptr, Type::MAP),
 		elements(elements)
 	{}
 
-	std::map<std::string, Node*> elements;
+	// Kept in source order, which is the order the map iterates in.
+	std::vector<std::pair<std::string, Node*>> elements;
 };
 
 class PropertyAccessNode : public Node {
@@ -297,16 +431,33 @@ public:
 		Node(token, nullptr, nullptr, Type::PROPERTY_ACCESS),
 		var_name(var_name),
 		path(path)
-	{}
+	{
+		for (auto part : path) {
+			auto& key = std::get<std::string>(part->value);
+			steps.push_back({ key, MapStorage::hash(key), 0, MapStorage::NPOS });
+		}
+	}
+
+	// One resolved key per path part, with an inline cache of the map
+	// shape it was last found in and the entry index it was found at.
+	struct Step {
+		std::string key;
+		size_t hash;
+		uint64_t shape;
+		size_t index;
+	};
 
 	std::string var_name;
 	std::vector<Token*> path;
+	std::vector<Step> steps;
 };
 
+// `target` is the PropertyAccessNode being written to, its last step is
+// the key set on the map reached by the steps before it.
 class PropertyAssignmentNode : public Node {
 public:
-	PropertyAssignmentNode(Token* token, Node* node) :
-		Node(token, node, nullptr, Type::PROPERTY_ASSIGN),
+	PropertyAssignmentNode(Token* token, Node* target, Node* value) :
+		Node(token, target, value, Type::PROPERTY_ASSIGN),
 		start(token->start),
 		end(token->end)
 	{}
@@ -325,17 +476,20 @@ public:
 	) :
 		Node(token, index, nullptr, Type::INDEX_ACCESS),
 		start(token->start),
-		end(token->end)
+		end(token->end),
+		quickening(Quickening::UNSEEN)
 	{}
 
 	std::shared_ptr<Cursor> start;
 	std::shared_ptr<Cursor> end;
+	Quickening quickening;
 };
 
+// `token` names the container, left is the index and right the value.
 class IndexAssignmentNode : public Node {
 public:
-	IndexAssignmentNode(Token* token, Node* node) :
-		Node(token, node, nullptr, Type::INDEX_ASSIGN),
+	IndexAssignmentNode(Token* token, Node* index, Node* value) :
+		Node(token, index, value, Type::INDEX_ASSIGN),
 		start(token->start),
 		end(token->end)
 	{}
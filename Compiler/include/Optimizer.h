@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+#include "Nodes.h"
+
+// Rewrites a parsed file before it runs. Passes only make changes the
+// interpreter cannot observe, anything they cannot prove is left as is.
+// The tree is verified after every pass.
+//
+// Inlining replaces calls to small top-level functions with their body,
+// the parameters substituted by the arguments. The function must be
+// bound once in the whole program, its body a single expression without
+// assignments, loops, definitions or calls to itself, and the arguments
+// literals or names. Functions that run later than their call site, and
+// bodies that would see a local of the caller instead of a global, are
+// not inlined.
+//
+// Hoisting wraps the expressions of a `for` or `while` loop that read
+// nothing the loop writes in an InvariantNode, computed once per run of
+// the loop. Reduction replaces `i * n` in a numeric loop over `i` with an
+// InductionNode the loop keeps up to date by addition. Both only touch
+// loops that cannot run again before they finish: no calls to functions
+// of the program, no definitions and no yields.
+class Optimizer {
+public:
+	// Nodes a function body may count to be inlined.
+	static constexpr unsigned int INLINE_BUDGET = 24;
+
+	struct Pass {
+		std::string name;
+		unsigned int changes;
+		// In milliseconds, verification included.
+		double time;
+	};
+
+	// Returns false when a pass left an invalid tree, see `error`.
+	bool optimize(std::vector<Node*>& program);
+	bool verify(const std::vector<Node*>& program);
+	unsigned int changes(const std::string& pass) const;
+
+	// The slots holding the children of `node`, in evaluation order.
+	static std::vector<Node**> children(Node* node);
+	static unsigned int size(Node* node);
+
+	std::vector<Pass> statistics;
+	std::string error;
+
+private:
+	struct Candidate {
+		FunctionDefinitionNode* definition;
+		size_t statement;
+		std::vector<std::string> parameters;
+	};
+
+	// What a loop body and condition write. `mutates` is set when they
+	// may change an array or map in place.
+	struct Loop {
+		std::set<std::string> written;
+		bool mutates = false;
+	};
+
+	void bindings(Node* node, std::map<std::string, unsigned int>& counts);
+	unsigned int inline_program(std::vector<Node*>& program);
+	unsigned int inline_calls(Node*& node, size_t statement);
+	Node* expand(FunctionCallNode* call, const Candidate& candidate);
+	bool inlinable(
+		Node* node,
+		const std::string& name,
+		const std::map<std::string, Node*>& arguments,
+		std::set<std::string>& used
+	);
+	Node* clone(Node* node, const std::map<std::string, Node*>& arguments);
+
+	bool analyze(Node* node, Loop& loop);
+	bool pure(Node* call, bool& reads);
+	bool invariant(Node* node, const Loop& loop);
+	unsigned int hoist(Node*& node);
+	unsigned int wrap(Node*& node, const Loop& loop, std::vector<InvariantNode*>& invariants);
+	unsigned int reduce(Node*& node);
+	unsigned int replace_products(Node*& node, const std::string& variable, std::vector<InductionNode*>& inductions);
+	bool check(Node* node, std::set<Node*>& seen, std::vector<Node*>& loops);
+
+	std::map<std::string, Candidate> candidates;
+	std::map<std::string, unsigned int> bound;
+	// Every name the program reads or binds.
+	std::set<std::string> names;
+	// Names bound by each function enclosing the node being rewritten.
+	std::vector<std::set<std::string>> locals;
+};
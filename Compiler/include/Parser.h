@@ -68,6 +68,8 @@ public:
 
 	std::vector<Token*> tokens;
 	Token* current_token;
+	// `yield` expressions parsed in the function body being parsed.
+	unsigned int yields;
 	size_t index;
 	bool debug;
 	double parsing_time;
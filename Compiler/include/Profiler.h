@@ -1,17 +1,70 @@
 #pragma once
 
-#include <time.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
 
 class Profiler {
 public:
+	typedef std::chrono::steady_clock Clock;
+
+	// Aggregated timings of every scope sharing the same name.
+	struct Stat {
+		const char* category;
+		unsigned long long count;
+		double total;
+		double min;
+		double max;
+	};
+
+	// One completed scope, kept for the trace file.
+	struct Event {
+		std::string name;
+		const char* category;
+		Clock::time_point start;
+		Clock::time_point end;
+	};
+
+	// Measures the lifetime of a block when profiling is enabled.
+	class Scope {
+	public:
+		Scope(const std::string& name, const char* category = "phase");
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		bool active;
+		std::string name;
+		const char* category;
+		Clock::time_point start;
+	};
+
 	Profiler():
-		start(0),
-		end(0) {}
+		start(),
+		end() {}
+
+	static Clock::time_point now() {
+		return Clock::now();
+	}
 
+	// Elapsed time between start and end, in seconds.
 	double getReport() {
-		return ((double)end - (double)start) / CLOCKS_PER_SEC;
+		return std::chrono::duration<double>(end - start).count();
 	}
 
-	clock_t start;
-	clock_t end;
+	static void record(const std::string& name, const char* category, Clock::time_point start, Clock::time_point end);
+	static void reset();
+	static bool writeTrace(const std::string& path);
+
+	Clock::time_point start;
+	Clock::time_point end;
+
+	static bool enabled;
+	static bool tracing;
+	static std::map<std::string, Stat> stats;
+	static std::vector<Event> events;
+	static Clock::time_point origin;
 };
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "SharedString.h"
+#include "ArrayStorage.h"
+#include "MapStorage.h"
+
+#include <memory>
+#include <string>
+#include <variant>
+
+class Type;
+class Coroutine;
+
+// Lazy, read-only sequence consumed by `for x in ...`. A NUMBERS range
+// only stores its bounds, the other kinds are views sharing the storage
+// of the array, map or string they walk, so nothing is materialized.
+// Views read the source live: elements pushed while iterating are seen.
+// A STREAM wraps the coroutine of a generator call, it has no size or
+// indices and is consumed once by pulling values until it finishes.
+class Range {
+public:
+	enum Kind {
+		NUMBERS,
+		KEYS,
+		VALUES,
+		CHARACTERS,
+		STREAM
+	};
+
+	using Source = std::variant<
+		std::monostate,
+		ArrayStorage,
+		MapStorage,
+		SharedString,
+		std::shared_ptr<Coroutine>
+	>;
+
+	// Counts from `start` towards `end` (exclusive) like the `for` loop.
+	Range(int start, int end, int step = 1);
+	Range(Kind kind, const Source& source);
+	Range(std::shared_ptr<Coroutine> stream);
+
+	Kind kind() const { return type; }
+	const Source& source() const { return origin; }
+	Coroutine* stream() const;
+
+	int start() const { return first; }
+	int step() const { return increment; }
+	// Always 0 for a STREAM, its length is unknown until it is drained.
+	size_t size() const;
+
+	// Boxes the element at `index` into a new value, for index access and
+	// materializing. Loops read elements straight from the source instead.
+	Type* at(size_t index) const;
+
+	std::string describe() const;
+
+	friend bool operator==(const Range& a, const Range& b);
+	friend bool operator!=(const Range& a, const Range& b) { return !(a == b); }
+	friend bool operator<(const Range& a, const Range& b) { return a.size() < b.size(); }
+	friend bool operator>(const Range& a, const Range& b) { return a.size() > b.size(); }
+	friend bool operator<=(const Range& a, const Range& b) { return a.size() <= b.size(); }
+	friend bool operator>=(const Range& a, const Range& b) { return a.size() >= b.size(); }
+
+private:
+	Kind type;
+	int first;
+	int last;
+	int increment;
+	size_t count;
+	Source origin;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Statistical profiler for Bird code. A background thread raises a tick at
+// a fixed interval and the interpreter takes the sample at its next
+// safepoint (node visit or call return), so the running script never
+// has to be suspended from the outside.
+class Sampler {
+public:
+	struct Frame {
+		std::string name;
+		int line;
+	};
+
+	// Pushes a Bird-level frame for the lifetime of a call.
+	class Call {
+	public:
+		Call(const std::string& name, int line);
+		~Call();
+
+		Call(const Call&) = delete;
+		Call& operator=(const Call&) = delete;
+
+	private:
+		bool active;
+	};
+
+	static void start(std::chrono::microseconds interval = std::chrono::microseconds(1000));
+	static void stop();
+	static void reset();
+	static void sample(int line);
+	static bool write(const std::string& path);
+
+	static bool running;
+	static std::atomic<unsigned int> ticks;
+	static std::vector<Frame> frames;
+	static std::unordered_map<std::string, unsigned long long> samples;
+	static unsigned long long total;
+};
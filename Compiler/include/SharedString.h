@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <ostream>
+
+// Text of a string value. Up to INLINE_CAPACITY characters are stored in the
+// handle itself; longer text lives in a reference counted block, so copying
+// a value between literals, symbols and results never copies characters.
+class SharedString {
+public:
+	static const size_t INLINE_CAPACITY = 22;
+
+	SharedString();
+	SharedString(const char* text);
+	SharedString(const std::string& text);
+	SharedString(std::string_view text);
+	SharedString(const SharedString& other);
+	SharedString(SharedString&& other) noexcept;
+	~SharedString();
+
+	SharedString& operator=(const SharedString& other);
+	SharedString& operator=(SharedString&& other) noexcept;
+
+	const char* data() const;
+	const char* c_str() const { return data(); }
+	size_t size() const;
+	size_t length() const { return size(); }
+	bool empty() const { return size() == 0; }
+	std::string_view view() const { return std::string_view(data(), size()); }
+	std::string str() const { return std::string(data(), size()); }
+	operator std::string_view() const { return view(); }
+
+	// Blocks are shared, so appending only writes in place when this handle
+	// is the block's sole owner, otherwise the text is copied first.
+	void append(std::string_view text);
+	void reserve(size_t capacity);
+
+	bool isInline() const;
+	size_t references() const;
+
+	// Returns the shared handle for `text`, literals with the same contents
+	// resolve to the same block for the lifetime of the process.
+	static SharedString intern(std::string_view text);
+	static size_t interned();
+
+	static SharedString concat(std::string_view left, std::string_view right);
+
+private:
+	struct Block {
+		size_t references;
+		size_t size;
+		size_t capacity;
+		char text[1];
+	};
+
+	static const unsigned char HEAP = 0xFF;
+
+	static Block* allocate(size_t capacity);
+	void assign(std::string_view text);
+	void release();
+
+	union {
+		Block* block;
+		char buffer[INLINE_CAPACITY + 1];
+	};
+	unsigned char small;
+};
+
+bool operator==(const SharedString& a, const SharedString& b);
+bool operator!=(const SharedString& a, const SharedString& b);
+bool operator<(const SharedString& a, const SharedString& b);
+bool operator>(const SharedString& a, const SharedString& b);
+bool operator<=(const SharedString& a, const SharedString& b);
+bool operator>=(const SharedString& a, const SharedString& b);
+std::ostream& operator<<(std::ostream& stream, const SharedString& string);
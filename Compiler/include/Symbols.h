@@ -1,9 +1,15 @@
 #pragma once
 
 #include "Platform.h"
+#include "SharedString.h"
+#include "ArrayStorage.h"
+#include "MapStorage.h"
+#include "Range.h"
 
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
+#include <functional>
 
 class Function;
 class File;
@@ -15,17 +21,20 @@ using DynamicType = std::variant<
 	int,
 	bool,
 	Function*,
-	std::string,
-	std::vector<Type*>,
+	SharedString,
+	ArrayStorage,
 	File*,
-	std::map<std::string, Type*>
+	MapStorage,
+	Range
 >;
 
 class Symbols {
 public:
 	Symbols(Symbols* parent = nullptr);
+	~Symbols();
 
 	typedef std::unordered_map<std::string, DynamicType> SymbolsMap;
+	typedef std::function<bool(const std::string&, DynamicType&)> Resolver;
 
 	SymbolsMap::iterator get(const std::string& name);
 	void set(const std::string& name, DynamicType value);
@@ -33,4 +42,18 @@ public:
 	
 	SymbolsMap symbols;
 	Symbols* parent;
+	Resolver resolver;
+
+	// Bumped whenever a function is bound, rebound or unbound in any scope,
+	// when a new local hides a function a call site cached, and when a scope
+	// that bound a function is dropped. Call sites cache their callee
+	// against it.
+	static uint64_t version;
+	// Names call sites have cached a callee under.
+	static std::unordered_set<std::string> callees;
+
+private:
+	const DynamicType* shadowed(const std::string& name) const;
+
+	bool functions;
 };
@@ -2,6 +2,7 @@
 
 #include "Cursor.h"
 #include "Platform.h"
+#include "Allocations.h"
 
 #include <vector>
 #include <variant>
@@ -46,6 +47,7 @@ public:
 	static std::vector<std::string> keywords;
 
 	Token(Token* token) {
+		Allocations::record(Allocations::Kind::TOKEN, sizeof(Token));
 		type = token->type;
 		value = token->value;
 		start = token->start;
@@ -1,6 +1,7 @@
 #pragma once
 #include <map>
 #include "Context.h"
+#include "Allocations.h"
 
 class Number;
 class Function;
@@ -18,10 +19,11 @@ using DynamicType = std::variant<
 	int,
 	bool,
 	Function*,
-	std::string,
-	std::vector<Type*>,
+	SharedString,
+	ArrayStorage,
 	File*,
-	std::map<std::string, Type*>
+	MapStorage,
+	Range
 >;
 
 class Type {
@@ -35,6 +37,7 @@ public:
 		ARRAY,
 		FILE,
 		MAP,
+		RANGE,
 		OBJECT
 	};
 
@@ -46,9 +49,14 @@ public:
 	);
 
 	friend std::ostream& operator << (std::ostream& stream, Type* type);
-	virtual RuntimeResult* execute(const std::vector<Type*>& args, Context* context);
+	// `checked` is set by call sites whose argument count the callee
+	// already accepted once, the arity check is skipped.
+	virtual RuntimeResult* execute(const std::vector<Type*>& args, Context* context, bool checked = false);
 	inline bool is(Native type) { return value.index() == type; }
 
+	// Wraps a raw value in the runtime class that implements its operators.
+	static Type* from(const DynamicType& value);
+
 	static void printArray(std::ostream& stream, Array* array);
 	static void printFunction(std::ostream& stream, Function* function);
 	static void printString(std::ostream& stream, String* string);
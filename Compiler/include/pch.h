@@ -12,6 +12,7 @@
 #include <any>
 #include <limits>
 #include <fstream>
+#include <chrono>
 
 #ifdef PLATFORM_LINUX
 #include <experimental/filesystem>
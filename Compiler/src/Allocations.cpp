@@ -0,0 +1,106 @@
+#include "pch.h"
+#include "Allocations.h"
+#include "Nodes.h"
+#include "Type.h"
+
+static_assert(
+	Allocations::KINDS - Allocations::NODE == Node::Type::INDUCTION + 1,
+	"Allocations node kinds must follow Node::Type"
+);
+
+Allocations::Phase Allocations::phase = Allocations::Phase::EVAL;
+Allocations::Stat Allocations::stats[Allocations::PHASES][Allocations::KINDS] = {};
+const size_t Allocations::type_size = sizeof(Type);
+
+// Indexed by Node::Type.
+static const size_t node_sizes[] = {
+	sizeof(Node),
+	sizeof(NumericNode),
+	sizeof(BinaryOperationNode),
+	sizeof(UnaryOperationNode),
+	sizeof(VariableAccessNode),
+	sizeof(VariableAssignmentNode),
+	sizeof(IfStatementNode),
+	sizeof(ForStatementNode),
+	sizeof(WhileStatementNode),
+	sizeof(FunctionDefinitionNode),
+	sizeof(FunctionCallNode),
+	sizeof(StringNode),
+	sizeof(ArrayNode),
+	sizeof(MapNode),
+	sizeof(PropertyAccessNode),
+	sizeof(PropertyAssignmentNode),
+	sizeof(IndexAccessNode),
+	sizeof(IndexAssignmentNode),
+	sizeof(YieldNode),
+	sizeof(InvariantNode),
+	sizeof(InductionNode)
+};
+
+static const char* names[] = {
+	"Token",
+	"RuntimeResult",
+	"Type",
+	"Number",
+	"String",
+	"Array",
+	"Map",
+	"File",
+	"Function",
+	"NativeFunction",
+	"Object",
+	"Node",
+	"NumericNode",
+	"BinaryOperationNode",
+	"UnaryOperationNode",
+	"VariableAccessNode",
+	"VariableAssignmentNode",
+	"IfStatementNode",
+	"ForStatementNode",
+	"WhileStatementNode",
+	"FunctionDefinitionNode",
+	"FunctionCallNode",
+	"StringNode",
+	"ArrayNode",
+	"MapNode",
+	"PropertyAccessNode",
+	"PropertyAssignmentNode",
+	"IndexAccessNode",
+	"IndexAssignmentNode",
+	"YieldNode",
+	"InvariantNode",
+	"InductionNode"
+};
+
+static_assert(sizeof(node_sizes) / sizeof(node_sizes[0]) == Node::Type::INDUCTION + 1, "Missing node size");
+static_assert(sizeof(names) / sizeof(names[0]) == Allocations::KINDS, "Missing allocation kind name");
+
+void Allocations::node(int type)
+{
+	record((Kind)(NODE + type), node_sizes[type]);
+}
+
+void Allocations::reset()
+{
+	for (auto& phase_stats : stats) {
+		for (auto& stat : phase_stats)
+			stat = Stat{ 0, 0 };
+	}
+}
+
+const char* Allocations::name(int kind)
+{
+	return names[kind];
+}
+
+Allocations::Stat Allocations::total(int kind)
+{
+	Stat total = { 0, 0 };
+
+	for (auto& phase_stats : stats) {
+		total.count += phase_stats[kind].count;
+		total.bytes += phase_stats[kind].bytes;
+	}
+
+	return total;
+}
@@ -6,27 +6,24 @@
 Array::Array(const DynamicType& value) :
 	Type(value)
 {
+	Allocations::refine(Allocations::Kind::ARRAY, sizeof(Array));
 }
 
 std::pair<Type*, Error*> Array::compare_less_than(Type* other)
 {
-	auto array = std::get<std::vector<Type*>>(value);
-	array.push_back(other);
-	value = std::move(array);
+	std::get<ArrayStorage>(value).push(other);
 	return std::make_pair(this, nullptr);
 }
 
 std::pair<Type*, Error*> Array::subtract(Type* other)
 {
-	auto array = std::get<std::vector<Type*>>(value);
+	auto& array = std::get<ArrayStorage>(value);
 
 	if (other->is(Type::Native::INT) && array.size() > 0) {
 		auto index = std::get<int>(other->value);
 
-		if (index < array.size() && index >= 0) {
-			array.erase(array.begin() + index);
-			value = std::move(array);
-		}
+		if (index < array.size() && index >= 0)
+			array.erase(index);
 	}
 
 	return std::make_pair(this, nullptr);
@@ -34,21 +31,17 @@ std::pair<Type*, Error*> Array::subtract(Type* other)
 
 std::pair<Type*, Error*> Array::add(Type* other)
 {
-	auto array = std::get<std::vector<Type*>>(value);
-	auto elements = std::get<std::vector<Type*>>(other->value);
-	std::vector<Type*>::iterator it = elements.begin();
+	if (!other->is(Type::Native::ARRAY))
+		return std::pair<Type*, Error*>();
 
-	for (; it != elements.end(); ++it)
-		array.push_back(*it);
-	
-	value = std::move(array);
+	std::get<ArrayStorage>(value).extend(std::get<ArrayStorage>(other->value));
 
 	return std::make_pair(this, nullptr);
 }
 
 std::pair<Type*, Error*> Array::compare_greater_than(Type* other)
 {
-	auto array = std::get<std::vector<Type*>>(value);
+	auto& array = std::get<ArrayStorage>(value);
 
 	if (other->is(Type::Native::INT)) {
 		auto index = std::get<int>(other->value);
@@ -64,6 +57,5 @@ std::pair<Type*, Error*> Array::compare_greater_than(Type* other)
 
 std::pair<Type*, Error*> Array::modulus(Type* other)
 {
-	auto array = std::get<std::vector<Type*>>(value);
-	return std::make_pair(new Number((int)array.size()), nullptr);
+	return std::make_pair(new Number((int)std::get<ArrayStorage>(value).size()), nullptr);
 }
@@ -0,0 +1,259 @@
+#include "pch.h"
+#include "ArrayStorage.h"
+#include "Number.h"
+
+static ArrayStorage::Kind packedKind(Type* element)
+{
+	if (element == nullptr)
+		return ArrayStorage::Kind::BOXED;
+
+	switch (element->value.index()) {
+	case Type::Native::INT:
+		return ArrayStorage::Kind::INTS;
+	case Type::Native::DOUBLE:
+		return ArrayStorage::Kind::DOUBLES;
+	default:
+		return ArrayStorage::Kind::BOXED;
+	}
+}
+
+ArrayStorage::ArrayStorage() :
+	storage(std::make_shared<Storage>())
+{
+}
+
+ArrayStorage::ArrayStorage(const std::vector<Type*>& elements) :
+	storage(std::make_shared<Storage>())
+{
+	auto kind = elements.empty() ? Kind::BOXED : packedKind(elements.front());
+
+	for (auto element : elements) {
+		if (packedKind(element) != kind) {
+			kind = Kind::BOXED;
+			break;
+		}
+	}
+
+	storage->kind = kind;
+
+	switch (kind) {
+	case Kind::INTS:
+		storage->ints.reserve(elements.size());
+
+		for (auto element : elements)
+			storage->ints.push_back(std::get<int>(element->value));
+		break;
+	case Kind::DOUBLES:
+		storage->doubles.reserve(elements.size());
+
+		for (auto element : elements)
+			storage->doubles.push_back(std::get<double>(element->value));
+		break;
+	default:
+		storage->boxed = elements;
+		break;
+	}
+}
+
+ArrayStorage::ArrayStorage(std::vector<int>&& ints) :
+	storage(std::make_shared<Storage>())
+{
+	storage->kind = Kind::INTS;
+	storage->ints = std::move(ints);
+}
+
+ArrayStorage::ArrayStorage(std::vector<double>&& doubles) :
+	storage(std::make_shared<Storage>())
+{
+	storage->kind = Kind::DOUBLES;
+	storage->doubles = std::move(doubles);
+}
+
+size_t ArrayStorage::size() const
+{
+	switch (storage->kind) {
+	case Kind::INTS:
+		return storage->ints.size();
+	case Kind::DOUBLES:
+		return storage->doubles.size();
+	default:
+		return storage->boxed.size();
+	}
+}
+
+Type* ArrayStorage::at(size_t index) const
+{
+	switch (storage->kind) {
+	case Kind::INTS:
+		return new Number(storage->ints.at(index));
+	case Kind::DOUBLES:
+		return new Number(storage->doubles.at(index));
+	default:
+		return storage->boxed.at(index);
+	}
+}
+
+void ArrayStorage::push(Type* element)
+{
+	prepare(element);
+
+	switch (storage->kind) {
+	case Kind::INTS:
+		storage->ints.push_back(std::get<int>(element->value));
+		break;
+	case Kind::DOUBLES:
+		storage->doubles.push_back(std::get<double>(element->value));
+		break;
+	default:
+		storage->boxed.push_back(element);
+		break;
+	}
+}
+
+void ArrayStorage::insert(size_t index, Type* element)
+{
+	prepare(element);
+
+	switch (storage->kind) {
+	case Kind::INTS:
+		storage->ints.insert(storage->ints.begin() + index, std::get<int>(element->value));
+		break;
+	case Kind::DOUBLES:
+		storage->doubles.insert(storage->doubles.begin() + index, std::get<double>(element->value));
+		break;
+	default:
+		storage->boxed.insert(storage->boxed.begin() + index, element);
+		break;
+	}
+}
+
+void ArrayStorage::set(size_t index, Type* element)
+{
+	prepare(element);
+
+	switch (storage->kind) {
+	case Kind::INTS:
+		storage->ints.at(index) = std::get<int>(element->value);
+		break;
+	case Kind::DOUBLES:
+		storage->doubles.at(index) = std::get<double>(element->value);
+		break;
+	default:
+		storage->boxed.at(index) = element;
+		break;
+	}
+}
+
+Type* ArrayStorage::remove(size_t index)
+{
+	auto element = at(index);
+	erase(index);
+
+	return element;
+}
+
+void ArrayStorage::erase(size_t index)
+{
+	switch (storage->kind) {
+	case Kind::INTS:
+		storage->ints.erase(storage->ints.begin() + index);
+		break;
+	case Kind::DOUBLES:
+		storage->doubles.erase(storage->doubles.begin() + index);
+		break;
+	default:
+		storage->boxed.erase(storage->boxed.begin() + index);
+		break;
+	}
+}
+
+void ArrayStorage::extend(const ArrayStorage& other)
+{
+	// `a + a` appends the array to itself, work from a snapshot then.
+	if (shares(other)) {
+		ArrayStorage snapshot;
+		snapshot.extend(*this);
+		extend(snapshot);
+		return;
+	}
+
+	if (empty() && storage->kind == Kind::BOXED)
+		storage->kind = other.kind();
+
+	if (storage->kind == other.kind()) {
+		switch (storage->kind) {
+		case Kind::INTS:
+			storage->ints.insert(storage->ints.end(), other.ints().begin(), other.ints().end());
+			return;
+		case Kind::DOUBLES:
+			storage->doubles.insert(storage->doubles.end(), other.doubles().begin(), other.doubles().end());
+			return;
+		default:
+			storage->boxed.insert(storage->boxed.end(), other.storage->boxed.begin(), other.storage->boxed.end());
+			return;
+		}
+	}
+
+	unpack();
+	auto elements = other.elements();
+	storage->boxed.insert(storage->boxed.end(), elements.begin(), elements.end());
+}
+
+std::vector<Type*> ArrayStorage::elements() const
+{
+	if (storage->kind == Kind::BOXED)
+		return storage->boxed;
+
+	std::vector<Type*> elements;
+	elements.reserve(size());
+
+	for (size_t i = 0; i < size(); i++)
+		elements.push_back(at(i));
+
+	return elements;
+}
+
+std::vector<Type*>& ArrayStorage::boxed() const
+{
+	unpack();
+	return storage->boxed;
+}
+
+void ArrayStorage::prepare(Type* element)
+{
+	auto kind = packedKind(element);
+
+	if (empty() && storage->kind == Kind::BOXED)
+		storage->kind = kind;
+	else if (storage->kind != Kind::BOXED && kind != storage->kind)
+		unpack();
+}
+
+void ArrayStorage::unpack() const
+{
+	if (storage->kind == Kind::BOXED)
+		return;
+
+	storage->boxed = elements();
+	storage->kind = Kind::BOXED;
+	storage->ints = {};
+	storage->doubles = {};
+}
+
+bool operator==(const ArrayStorage& a, const ArrayStorage& b)
+{
+	if (a.shares(b))
+		return true;
+
+	if (a.kind() != b.kind())
+		return false;
+
+	switch (a.kind()) {
+	case ArrayStorage::Kind::INTS:
+		return a.ints() == b.ints();
+	case ArrayStorage::Kind::DOUBLES:
+		return a.doubles() == b.doubles();
+	default:
+		return a.storage->boxed == b.storage->boxed;
+	}
+}
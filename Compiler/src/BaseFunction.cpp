@@ -84,19 +84,37 @@ void BaseFunction::populate_arguments(
 
 		if (name.size() > 0 && value != nullptr) {
 			value->context = ctx;
-			ctx->symbols->set(name, value->value);
+			ctx->symbols->set(optional_name(name), value->value);
 		}
 	}
+
+	// Optional arguments that were not passed are bound to their own
+	// declaration ("mode?") so natives can detect the default.
+	for (size_t i = args.size(); i < names.size(); i++) {
+		if (names.at(i).find("?") != std::string::npos)
+			ctx->symbols->set(optional_name(names.at(i)), names.at(i));
+	}
+}
+
+std::string BaseFunction::optional_name(const std::string& name)
+{
+	if (!name.empty() && name.back() == '?')
+		return name.substr(0, name.size() - 1);
+
+	return name;
 }
 
 RuntimeResult* BaseFunction::check_and_populate_arguments(
 	const std::vector<std::string>& names,
 	const std::vector<Type*>& args,
-	Context* ctx
+	Context* ctx,
+	bool checked
 )
 {
 	RuntimeResult* result = new RuntimeResult();
-	result->record(check_arguments(names, args));
+
+	if (!checked)
+		result->record(check_arguments(names, args));
 
 	if (result->error != nullptr)
 		return result;
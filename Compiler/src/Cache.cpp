@@ -0,0 +1,665 @@
+#include "pch.h"
+#include <sstream>
+#include <iomanip>
+#include "Cache.h"
+#include "Profiler.h"
+
+#ifdef PLATFORM_WINDOWS
+#include <windows.h>
+#endif
+#ifdef PLATFORM_LINUX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+const uint32_t Cache::magic = 0x44524942; // "BIRD"
+const uint32_t Cache::version = 2;
+
+static const uint8_t NULL_NODE = 0xFF;
+
+// Flat little-endian encoding of the parsed program. Every node is written
+// in pre-order as its Node::Type followed by the fields its constructor needs,
+// so loading is a single pass over the mapped file.
+class CacheWriter {
+public:
+	void u8(uint8_t value) { buffer.push_back((char)value); }
+	void u32(uint32_t value) { buffer.append((const char*)&value, sizeof(value)); }
+	void u64(uint64_t value) { buffer.append((const char*)&value, sizeof(value)); }
+	void i32(int32_t value) { buffer.append((const char*)&value, sizeof(value)); }
+	void f64(double value) { buffer.append((const char*)&value, sizeof(value)); }
+
+	void string(const std::string& value) {
+		u32((uint32_t)value.size());
+		buffer.append(value);
+	}
+
+	void cursor(std::shared_ptr<Cursor> cursor) {
+		u8(cursor != nullptr);
+
+		if (cursor != nullptr) {
+			u64((uint64_t)cursor->index);
+			i32(cursor->line);
+			i32(cursor->column);
+		}
+	}
+
+	void token(Token* token) {
+		u8(token != nullptr);
+
+		if (token == nullptr)
+			return;
+
+		u8((uint8_t)token->type);
+		u8((uint8_t)token->value.index());
+
+		switch (token->value.index()) {
+		case 0: f64(std::get<double>(token->value)); break;
+		case 1: i32(std::get<int>(token->value)); break;
+		case 2: u8((uint8_t)std::get<char>(token->value)); break;
+		case 3: string(std::get<std::string>(token->value)); break;
+		}
+
+		cursor(token->start);
+		cursor(token->end);
+	}
+
+	bool node(Node* node) {
+		if (node == nullptr) {
+			u8(NULL_NODE);
+			return true;
+		}
+
+		u8((uint8_t)node->type);
+
+		switch (node->type) {
+		case Node::Type::NUMERIC:
+		case Node::Type::STRING:
+		case Node::Type::VARIABLE_ACCESS:
+			token(node->token);
+			return true;
+		case Node::Type::BINARY:
+			token(node->token);
+			return this->node(node->left) && this->node(node->right);
+		case Node::Type::UNARY:
+			token(node->token);
+			return this->node(((UnaryOperationNode*)node)->node);
+		case Node::Type::VARIABLE_ASSIGN:
+			token(node->token);
+			return this->node(node->left);
+		case Node::Type::INDEX_ACCESS:
+			token(node->token);
+			return this->node(node->left);
+		case Node::Type::IF_STATEMENT: {
+			auto if_node = (IfStatementNode*)node;
+			token(if_node->token);
+			u32((uint32_t)if_node->cases.size());
+
+			for (auto& if_case : if_node->cases) {
+				if (!this->node(if_case.first) || !this->node(if_case.second))
+					return false;
+			}
+
+			return this->node(if_node->else_case);
+		}
+		case Node::Type::FOR_STATEMENT: {
+			auto for_node = (ForStatementNode*)node;
+			token(for_node->token);
+
+			return this->node(for_node->start_value) &&
+				this->node(for_node->end_value) &&
+				this->node(for_node->step) &&
+				this->node(for_node->body);
+		}
+		case Node::Type::WHILE_STATEMENT: {
+			auto while_node = (WhileStatementNode*)node;
+			token(while_node->token);
+			return this->node(while_node->condition) && this->node(while_node->body);
+		}
+		case Node::Type::FN_DEFINITION: {
+			auto fn_node = (FunctionDefinitionNode*)node;
+			token(fn_node->token);
+			u32((uint32_t)fn_node->args_names.size());
+
+			for (auto arg : fn_node->args_names)
+				token(arg);
+
+			u8(fn_node->generator ? 1 : 0);
+
+			return this->node(fn_node->body);
+		}
+		case Node::Type::FN_CALL: {
+			auto call_node = (FunctionCallNode*)node;
+			token(call_node->token);
+
+			if (!this->node(call_node->callee))
+				return false;
+
+			u32((uint32_t)call_node->args_nodes.size());
+
+			for (auto arg : call_node->args_nodes) {
+				if (!this->node(arg))
+					return false;
+			}
+
+			return true;
+		}
+		case Node::Type::ARRAY: {
+			auto array_node = (ArrayNode*)node;
+			token(array_node->token);
+			u32((uint32_t)array_node->elements.size());
+
+			for (auto element : array_node->elements) {
+				if (!this->node(element))
+					return false;
+			}
+
+			return true;
+		}
+		case Node::Type::MAP: {
+			auto map_node = (MapNode*)node;
+			token(map_node->token);
+			u32((uint32_t)map_node->elements.size());
+
+			for (auto& element : map_node->elements) {
+				string(element.first);
+
+				if (!this->node(element.second))
+					return false;
+			}
+
+			return true;
+		}
+		case Node::Type::PROPERTY_ACCESS: {
+			auto property_node = (PropertyAccessNode*)node;
+			token(property_node->token);
+			string(property_node->var_name);
+			u32((uint32_t)property_node->path.size());
+
+			for (auto part : property_node->path)
+				token(part);
+
+			return true;
+		}
+		case Node::Type::PROPERTY_ASSIGN:
+		case Node::Type::INDEX_ASSIGN:
+			token(node->token);
+			return this->node(node->left) && this->node(node->right);
+		case Node::Type::YIELD:
+			token(node->token);
+			return this->node(node->left);
+		default:
+			return false;
+		}
+	}
+
+	std::string buffer;
+};
+
+class CacheReader {
+public:
+	CacheReader(const char* data, size_t size, const std::string& filename) :
+		data(data),
+		size(size),
+		position(0),
+		failed(false),
+		filename(filename)
+	{}
+
+	bool available(size_t count) {
+		if (failed || size - position < count) {
+			failed = true;
+			return false;
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	T read() {
+		T value = T();
+
+		if (available(sizeof(T))) {
+			memcpy(&value, data + position, sizeof(T));
+			position += sizeof(T);
+		}
+
+		return value;
+	}
+
+	uint8_t u8() { return read<uint8_t>(); }
+	uint32_t u32() { return read<uint32_t>(); }
+	uint64_t u64() { return read<uint64_t>(); }
+	int32_t i32() { return read<int32_t>(); }
+	double f64() { return read<double>(); }
+
+	uint32_t count() {
+		auto value = u32();
+
+		// Every element takes at least one byte, anything larger is corrupted.
+		if (!available(value))
+			return 0;
+
+		return value;
+	}
+
+	std::string string() {
+		auto length = u32();
+
+		if (!available(length))
+			return "";
+
+		std::string value(data + position, length);
+		position += length;
+
+		return value;
+	}
+
+	std::shared_ptr<Cursor> cursor() {
+		if (u8() == 0)
+			return nullptr;
+
+		auto index = (size_t)u64();
+		auto line = i32();
+		auto column = i32();
+
+		return std::make_shared<Cursor>(index, line, column, filename);
+	}
+
+	Token* token() {
+		if (u8() == 0)
+			return nullptr;
+
+		auto type = (Token::Type)u8();
+		auto tag = u8();
+		Token* token = new Token(type);
+
+		switch (tag) {
+		case 0: token->value = f64(); break;
+		case 1: token->value = (int)i32(); break;
+		case 2: token->value = (char)u8(); break;
+		case 3: token->value = string(); break;
+		default: failed = true; break;
+		}
+
+		token->start = cursor();
+		token->end = cursor();
+
+		return token;
+	}
+
+	Node* fail() {
+		failed = true;
+		return nullptr;
+	}
+
+	Node* node() {
+		auto kind = u8();
+
+		if (failed || kind == NULL_NODE)
+			return nullptr;
+
+		switch ((Node::Type)kind) {
+		case Node::Type::NUMERIC: {
+			auto token = this->token();
+			return token != nullptr ? new NumericNode(token) : fail();
+		}
+		case Node::Type::STRING: {
+			auto token = this->token();
+			return token != nullptr ? new StringNode(token) : fail();
+		}
+		case Node::Type::VARIABLE_ACCESS: {
+			auto token = this->token();
+			return token != nullptr ? new VariableAccessNode(token) : fail();
+		}
+		case Node::Type::BINARY: {
+			auto token = this->token();
+			auto left = node();
+			auto right = node();
+
+			if (failed || left == nullptr || right == nullptr)
+				return fail();
+
+			return new BinaryOperationNode(left, token, right);
+		}
+		case Node::Type::UNARY: {
+			auto token = this->token();
+			auto operand = node();
+
+			if (failed || operand == nullptr)
+				return fail();
+
+			return new UnaryOperationNode(operand, token);
+		}
+		case Node::Type::VARIABLE_ASSIGN: {
+			auto token = this->token();
+			auto value = node();
+
+			if (failed || token == nullptr || value == nullptr)
+				return fail();
+
+			return new VariableAssignmentNode(token, value);
+		}
+		case Node::Type::INDEX_ACCESS: {
+			auto token = this->token();
+			auto index = node();
+
+			if (failed || token == nullptr || index == nullptr)
+				return fail();
+
+			return new IndexAccessNode(token, index, token->start, token->end);
+		}
+		case Node::Type::IF_STATEMENT: {
+			auto token = this->token();
+			auto count = this->count();
+			std::vector<std::pair<Node*, Node*>> cases;
+
+			for (uint32_t i = 0; i < count && !failed; i++) {
+				auto condition = node();
+				auto expression = node();
+				cases.push_back(std::make_pair(condition, expression));
+			}
+
+			auto else_case = node();
+
+			if (failed || token == nullptr)
+				return fail();
+
+			return new IfStatementNode(token, cases, else_case);
+		}
+		case Node::Type::FOR_STATEMENT: {
+			auto token = this->token();
+			auto start_value = node();
+			auto end_value = node();
+			auto step = node();
+			auto body = node();
+
+			if (failed || token == nullptr || body == nullptr || body->token == nullptr)
+				return fail();
+
+			return new ForStatementNode(token, start_value, end_value, step, body);
+		}
+		case Node::Type::WHILE_STATEMENT: {
+			auto token = this->token();
+			auto condition = node();
+			auto body = node();
+
+			if (failed || condition == nullptr || body == nullptr ||
+				condition->token == nullptr || body->token == nullptr)
+				return fail();
+
+			return new WhileStatementNode(token, condition, body);
+		}
+		case Node::Type::FN_DEFINITION: {
+			auto token = this->token();
+			auto count = this->count();
+			std::vector<Token*> args_names;
+
+			for (uint32_t i = 0; i < count && !failed; i++)
+				args_names.push_back(this->token());
+
+			auto generator = u8() == 1;
+			auto body = node();
+
+			if (failed || body == nullptr)
+				return fail();
+
+			return new FunctionDefinitionNode(args_names, body, token, generator);
+		}
+		case Node::Type::FN_CALL: {
+			auto token = this->token();
+			auto callee = node();
+			auto count = this->count();
+			std::vector<Node*> args_nodes;
+
+			for (uint32_t i = 0; i < count && !failed; i++)
+				args_nodes.push_back(node());
+
+			if (failed || callee == nullptr)
+				return fail();
+
+			return new FunctionCallNode(token, callee, args_nodes);
+		}
+		case Node::Type::ARRAY: {
+			auto token = this->token();
+			auto count = this->count();
+			std::vector<Node*> elements;
+
+			for (uint32_t i = 0; i < count && !failed; i++)
+				elements.push_back(node());
+
+			return failed ? fail() : new ArrayNode(token, elements);
+		}
+		case Node::Type::MAP: {
+			auto token = this->token();
+			auto count = this->count();
+			std::vector<std::pair<std::string, Node*>> elements;
+
+			for (uint32_t i = 0; i < count && !failed; i++) {
+				auto key = string();
+				elements.emplace_back(key, node());
+			}
+
+			return failed ? fail() : new MapNode(token, elements);
+		}
+		case Node::Type::PROPERTY_ACCESS: {
+			auto token = this->token();
+			auto var_name = string();
+			auto count = this->count();
+			std::vector<Token*> path;
+
+			for (uint32_t i = 0; i < count && !failed; i++)
+				path.push_back(this->token());
+
+			return failed ? fail() : new PropertyAccessNode(token, var_name, path);
+		}
+		case Node::Type::PROPERTY_ASSIGN: {
+			auto token = this->token();
+			auto target = node();
+			auto value = node();
+
+			if (failed || target == nullptr || value == nullptr || target->type != Node::Type::PROPERTY_ACCESS)
+				return fail();
+
+			return new PropertyAssignmentNode(token, target, value);
+		}
+		case Node::Type::INDEX_ASSIGN: {
+			auto token = this->token();
+			auto index = node();
+			auto value = node();
+
+			if (failed || token == nullptr || index == nullptr || value == nullptr)
+				return fail();
+
+			return new IndexAssignmentNode(token, index, value);
+		}
+		case Node::Type::YIELD: {
+			auto token = this->token();
+			auto value = node();
+
+			if (failed || token == nullptr || value == nullptr)
+				return fail();
+
+			return new YieldNode(token, value);
+		}
+		default:
+			return fail();
+		}
+	}
+
+	const char* data;
+	size_t size;
+	size_t position;
+	bool failed;
+	std::string filename;
+};
+
+Cache::Cache(const std::string& directory) :
+	directory(directory),
+	hits(0),
+	misses(0),
+	loading_time(0.0)
+{
+	if (this->directory.empty())
+		this->directory = (std::filesystem::temp_directory_path() / "birdlang").string();
+}
+
+uint64_t Cache::hash(const std::string& source)
+{
+	// 64-bit FNV-1a
+	uint64_t value = 0xcbf29ce484222325ULL;
+
+	for (unsigned char c : source) {
+		value ^= c;
+		value *= 0x100000001b3ULL;
+	}
+
+	return value;
+}
+
+std::string Cache::path(uint64_t key)
+{
+	std::stringstream name;
+	name << std::hex << std::setfill('0') << std::setw(16) << key << ".bcache";
+
+	return (std::filesystem::path(directory) / name.str()).string();
+}
+
+bool Cache::load(uint64_t key, const std::string& filename, std::vector<Node*>& program)
+{
+	Allocations::Scope allocations(Allocations::Phase::PARSE);
+	Profiler profiler;
+	profiler.start = Profiler::now();
+
+	auto file_path = path(key);
+	const char* data = nullptr;
+	size_t size = 0;
+
+#ifdef PLATFORM_WINDOWS
+	HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	HANDLE mapping = NULL;
+
+	if (file != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER file_size;
+
+		if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+			mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+			if (mapping != NULL) {
+				data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				size = (size_t)file_size.QuadPart;
+			}
+		}
+	}
+#endif
+#ifdef PLATFORM_LINUX
+	int file = open(file_path.c_str(), O_RDONLY);
+
+	if (file >= 0) {
+		struct stat info;
+
+		if (fstat(file, &info) == 0 && info.st_size > 0) {
+			void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+			if (mapped != MAP_FAILED) {
+				data = (const char*)mapped;
+				size = (size_t)info.st_size;
+			}
+		}
+
+		close(file);
+	}
+#endif
+
+	bool loaded = false;
+
+	if (data != nullptr) {
+		CacheReader reader(data, size, filename);
+
+		if (reader.u32() == magic && reader.u32() == version && reader.u64() == key) {
+			auto count = reader.count();
+			std::vector<Node*> nodes;
+
+			for (uint32_t i = 0; i < count && !reader.failed; i++)
+				nodes.push_back(reader.node());
+
+			loaded = !reader.failed && reader.position == reader.size;
+
+			if (loaded)
+				program = nodes;
+		}
+	}
+
+#ifdef PLATFORM_WINDOWS
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapping != NULL)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+#endif
+#ifdef PLATFORM_LINUX
+	if (data != nullptr)
+		munmap((void*)data, size);
+#endif
+
+	if (loaded)
+		hits++;
+	else
+		misses++;
+
+	profiler.end = Profiler::now();
+	loading_time += profiler.getReport();
+
+	if (Profiler::enabled)
+		Profiler::record("cache", "phase", profiler.start, profiler.end);
+
+	return loaded;
+}
+
+bool Cache::store(uint64_t key, const std::vector<Node*>& program)
+{
+	CacheWriter writer;
+
+	writer.u32(magic);
+	writer.u32(version);
+	writer.u64(key);
+	writer.u32((uint32_t)program.size());
+
+	for (auto node : program) {
+		if (!writer.node(node))
+			return false;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	// Write under a unique name and rename, so concurrent interpreters never
+	// map a partially written entry.
+	auto file_path = path(key);
+	auto temporary = file_path + "." +
+		std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+
+	std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+
+	if (!stream)
+		return false;
+
+	stream.write(writer.buffer.data(), writer.buffer.size());
+	stream.close();
+
+	if (!stream) {
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+
+	std::filesystem::rename(temporary, file_path, error);
+
+	if (error) {
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+
+	return true;
+}
@@ -1,45 +1,60 @@
 #include "pch.h"
+#include <sstream>
+#include <iomanip>
 
 #include "Compiler.h"
 #include "Profiler.h"
+#include "Sampler.h"
+#include "Instrumentation.h"
+#include "Memory.h"
+#include "Metrics.h"
 #include "Utils.h"
 #include "ConsoleTable.h"
 #include "NativeFunction.h"
+#include "Jit.h"
+#include "Generator.h"
 
 using ConsoleTable = samilton::ConsoleTable;
 
+struct Constant {
+	const char* name;
+	Type::Native type;
+	double value;
+};
+
+static const Constant constants[] = {
+	{"null", Type::Native::BOOL, 0},
+	{"true", Type::Native::BOOL, 1},
+	{"false", Type::Native::BOOL, 0},
+	{"PI", Type::Native::DOUBLE, PI},
+	{"TAU", Type::Native::DOUBLE, TAU},
+	{"PHI", Type::Native::DOUBLE, 1.618033988749895},
+	{"EULER", Type::Native::DOUBLE, 2.718281828459045},
+	{"SQRT1_2", Type::Native::DOUBLE, 0.7071067811865476},
+	{"SQRT2", Type::Native::DOUBLE, 1.4142135623730951}
+};
+
 Compiler::Compiler(
 	bool debug_lexer,
 	bool debug_parser,
-	bool profiling
+	bool profiling,
+	bool caching,
+	bool startup_stats
 ) :
 	debug_lexer(debug_lexer),
 	debug_parser(debug_parser),
 	profiling(profiling),
-	interpreting_time(0.0)
+	caching(caching),
+	startup_stats(startup_stats),
+	interpreting_time(0.0),
+	builtins_materialized(0),
+	launched(std::chrono::steady_clock::now()),
+	first_evaluation()
 {
-	context = new Context("<program>");
-	symbols = new Symbols();
-
-	symbols->set("null", Type::Null);
-	symbols->set("true", Type::True);
-	symbols->set("false", Type::False);
+	context = nullptr;
+	symbols = nullptr;
 
-	symbols->set("PI", PI);
-	symbols->set("TAU", TAU);
-	symbols->set("PHI", 1.618033988749895);
-	symbols->set("EULER", 2.718281828459045);
-	symbols->set("SQRT1_2", 0.7071067811865476);
-	symbols->set("SQRT2", 1.4142135623730951);
-
-	auto it = NativeFunction::list.begin();
-
-	for (; it != NativeFunction::list.end(); ++it) {
-		NativeFunction* fn = new NativeFunction(it->first, nullptr, std::get<0>(it->second));
-		symbols->set(it->first, (Function*)fn);
-	}
-
-	context->symbols = symbols;
+	resetGlobals();
 
 	lexer = std::make_unique<Lexer>("<stdin>");
 	lexer->debug = debug_lexer;
@@ -48,7 +63,38 @@ Compiler::Compiler(
 	parser->debug = debug_parser;
 
 	interpreter = std::make_unique<Interpreter>();
+	cache = std::make_unique<Cache>();
+
+	if (profiling)
+		Profiler::enabled = true;
+
 	std::cout.precision(std::numeric_limits<double>::max_digits10);
+	constructed = std::chrono::steady_clock::now();
+}
+
+bool Compiler::resolve(const std::string& name, DynamicType& value)
+{
+	for (auto& constant : constants) {
+		if (name == constant.name) {
+			if (constant.type == Type::Native::BOOL)
+				value = constant.value != 0;
+			else
+				value = constant.value;
+
+			builtins_materialized++;
+			return true;
+		}
+	}
+
+	auto fn = NativeFunction::create(name);
+
+	if (fn == nullptr)
+		return false;
+
+	value = (Function*)fn;
+	builtins_materialized++;
+
+	return true;
 }
 
 void Compiler::interpret(const std::string& input)
@@ -57,43 +103,548 @@ void Compiler::interpret(const std::string& input)
 	parser->setTokens(tokens);
 	auto ast = parser->parse();
 
-	Profiler profiler;
-
 	if (ast != nullptr) {
 		if (ast->error != nullptr) {
 			std::cout << ast->error << '\n';
 		}
 		else {
-			if (profiling) {
-				profiler.start = clock();
-			}
+			bool first = first_evaluation == std::chrono::steady_clock::time_point();
+			auto result = evaluate(ast->node);
 
-			auto result = interpreter->visit(ast->node, context);
-
-			if (profiling) {
-				profiler.end = clock();
-				interpreting_time = profiler.getReport();
+			if (profiling)
 				printStatistics();
+
+			if (!trace_path.empty())
+				Profiler::writeTrace(trace_path);
+
+			if (!samples_path.empty())
+				writeSamples();
+
+			if (!metrics_path.empty())
+				writeMetrics();
+
+			if (Instrumentation::enabled) {
+				printInstrumentation(input);
+				Instrumentation::reset();
 			}
 
-			if (result->error != nullptr) {
-				if (strcmp(typeid(*result->error).name(), "class RuntimeError") == 0) {
-					RuntimeError* error = static_cast<RuntimeError*>(result->error);
-
-					if (error != nullptr) {
-						std::cout << error << '\n';
-					}
-				}
-				else {
-					std::cout << result->error << '\n';
-				}
+			if (startup_stats && first)
+				printStartupStatistics();
+
+			report(result);
+		}
+	}
+}
+
+bool Compiler::compileFile(const std::string& filename, std::string& source, std::vector<Node*>& program)
+{
+	std::ifstream stream(filename, std::ios::binary);
+
+	if (!stream) {
+		std::cout << "Unable to open file: " << filename << '\n';
+		return false;
+	}
+
+	source.assign(
+		(std::istreambuf_iterator<char>(stream)),
+		std::istreambuf_iterator<char>()
+	);
+
+	uint64_t key = Cache::hash(source);
+	double lexing_time = 0.0;
+	double parsing_time = 0.0;
+
+	if (!caching || !cache->load(key, filename, program)) {
+		std::stringstream lines(source);
+		std::string line;
+		int line_number = 0;
+
+		lexer->filename = filename;
+
+		for (; std::getline(lines, line); line_number++) {
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+
+			if (line.find_first_not_of(" \t") == std::string::npos)
+				continue;
+
+			auto tokens = lexer->index_tokens(line, line_number);
+			parser->setTokens(tokens);
+			auto ast = parser->parse();
+
+			lexing_time += lexer->lexing_time;
+			parsing_time += parser->parsing_time;
+
+			if (ast == nullptr)
+				return false;
+
+			if (ast->error != nullptr) {
+				std::cout << ast->error << '\n';
+				return false;
 			}
-			else {
-				if (result->value != nullptr) {
-					std::cout << result->value << '\n';
-				}
+
+			program.push_back(ast->node);
+		}
+
+		if (caching)
+			cache->store(key, program);
+	}
+
+	lexer->lexing_time = lexing_time;
+	parser->parsing_time = parsing_time;
+
+	// The cache keeps the program as parsed, it is optimized on each load.
+	// Instrumented runs count visits per source line, which inlined
+	// bodies would move.
+	if (optimizer != nullptr && !Instrumentation::enabled && !optimizer->optimize(program)) {
+		std::cout << "Optimizer: " << optimizer->error << '\n';
+		return false;
+	}
+
+	// Statements of a file are only checked for errors, never echoed.
+	for (auto node : program)
+		Node::discard(node);
+
+	return true;
+}
+
+void Compiler::interpretFile(const std::string& filename)
+{
+	std::string source;
+	std::vector<Node*> program;
+
+	if (!compileFile(filename, source, program))
+		return;
+
+	run(program, source);
+}
+
+bool Compiler::compileToExecutable(const std::string& filename, const std::string& output)
+{
+	std::string source;
+	std::vector<Node*> program;
+
+	if (!compileFile(filename, source, program))
+		return false;
+
+	Generator generator;
+	std::string code;
+
+	if (!std::filesystem::exists(generator.library) || !std::filesystem::exists(generator.include_directory)) {
+		std::cout << "Compiler library or headers not found at " << generator.library
+			<< " and " << generator.include_directory
+			<< ". Set BIRD_LIBRARY and BIRD_INCLUDE to their paths" << '\n';
+		return false;
+	}
+
+	if (!generator.emit(program, filename, code)) {
+		std::cout << "Unable to compile " << filename << " ahead of time" << '\n';
+		return false;
+	}
+
+	if (!generator.build(code, output)) {
+		std::cout << "Build failed: " << generator.command << '\n';
+		return false;
+	}
+
+	return true;
+}
+
+bool Compiler::run(const std::vector<Node*>& program, const std::string& source)
+{
+	double evaluation_time = 0.0;
+	bool failed = false;
+
+	for (auto node : program) {
+		auto result = evaluate(node);
+		evaluation_time += interpreting_time;
+		report(result, false);
+
+		if (result != nullptr && result->error != nullptr) {
+			failed = true;
+			break;
+		}
+	}
+
+	if (profiling) {
+		interpreting_time = evaluation_time;
+		printStatistics();
+	}
+
+	if (!trace_path.empty() && !Profiler::writeTrace(trace_path))
+		std::cout << "Unable to write trace file: " << trace_path << '\n';
+
+	if (!samples_path.empty()) {
+		Sampler::stop();
+		writeSamples();
+	}
+
+	if (Instrumentation::enabled)
+		printInstrumentation(source);
+
+	if (!metrics_path.empty())
+		writeMetrics();
+
+	if (startup_stats)
+		printStartupStatistics();
+
+	return !failed;
+}
+
+void Compiler::resetGlobals()
+{
+	delete symbols;
+	delete context;
+
+	context = new Context("<program>");
+	symbols = new Symbols();
+
+	symbols->resolver = [this](const std::string& name, DynamicType& value) {
+		return resolve(name, value);
+	};
+
+	context->symbols = symbols;
+}
+
+void Compiler::benchmarkFile(const std::string& filename, unsigned int runs, unsigned int warmup, bool json)
+{
+	using milliseconds = std::chrono::duration<double, std::milli>;
+
+	std::string source;
+	std::vector<Node*> program;
+
+	if (runs == 0 || !compileFile(filename, source, program))
+		return;
+
+	std::vector<double> durations;
+	unsigned long long allocations = 0;
+	unsigned long long bytes = 0;
+
+	// The script output would drown the report, discard it while running.
+	std::ostringstream discarded;
+	auto output = std::cout.rdbuf(discarded.rdbuf());
+
+	for (unsigned int run = 0; run < warmup + runs; ++run) {
+		// Every run starts from the globals a fresh process would have.
+		resetGlobals();
+
+		auto before = Memory::counters();
+		auto start = std::chrono::steady_clock::now();
+		RuntimeResult* result = nullptr;
+
+		for (auto node : program) {
+			result = interpreter->visit(node, context);
+
+			if (result != nullptr && result->error != nullptr)
+				break;
+		}
+
+		auto end = std::chrono::steady_clock::now();
+		auto after = Memory::counters();
+
+		discarded.str("");
+
+		if (result != nullptr && result->error != nullptr) {
+			std::cout.rdbuf(output);
+			report(result);
+			return;
+		}
+
+		if (run < warmup)
+			continue;
+
+		durations.push_back(milliseconds(end - start).count());
+		allocations += after.allocations - before.allocations;
+		bytes += after.bytes - before.bytes;
+	}
+
+	std::cout.rdbuf(output);
+
+	std::vector<double> sorted(durations);
+	std::sort(sorted.begin(), sorted.end());
+
+	// Nearest-rank percentile, exact for the samples we have.
+	auto percentile = [&sorted](double p) {
+		size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+		return sorted[rank > 0 ? rank - 1 : 0];
+	};
+
+	double mean = 0.0;
+
+	for (auto duration : durations)
+		mean += duration;
+
+	mean /= durations.size();
+
+	if (json) {
+		std::cout << std::fixed << std::setprecision(6)
+			<< "{\"script\": \"" << filename << "\", "
+			<< "\"runs\": " << runs << ", "
+			<< "\"warmup\": " << warmup << ", "
+			<< "\"min_ms\": " << sorted.front() << ", "
+			<< "\"median_ms\": " << percentile(50) << ", "
+			<< "\"p90_ms\": " << percentile(90) << ", "
+			<< "\"p99_ms\": " << percentile(99) << ", "
+			<< "\"max_ms\": " << sorted.back() << ", "
+			<< "\"mean_ms\": " << mean << ", "
+			<< "\"allocs_per_run\": " << allocations / runs << ", "
+			<< "\"bytes_per_run\": " << bytes / runs << "}\n"
+			<< std::defaultfloat;
+		std::cout.precision(std::numeric_limits<double>::max_digits10);
+		return;
+	}
+
+	std::cout << '\n';
+	Utils::title("BENCHMARK", 15, false);
+
+	ConsoleTable table(1, 2);
+	ConsoleTable::TableChars chars;
+
+	chars.topLeft = '+';
+	chars.topRight = '+';
+	chars.downLeft = '+';
+	chars.downRight = '+';
+	chars.topDownSimple = '-';
+	chars.leftRightSimple = '|';
+	chars.leftSeparation = '+';
+	chars.rightSeparation = '+';
+	chars.centreSeparation = '+';
+	chars.topSeparation = '+';
+	chars.downSeparation = '+';
+
+	table.setTableChars(chars);
+
+	table[0][0] = "Metric";
+	table[0][1] = "Value";
+
+	table[1][0] = "Runs (warmup)";
+	table[1][1] = std::to_string(runs) + " (" + std::to_string(warmup) + ")";
+
+	table[2][0] = "Min (ms)";
+	table[2][1] = sorted.front();
+
+	table[3][0] = "Median (ms)";
+	table[3][1] = percentile(50);
+
+	table[4][0] = "p90 (ms)";
+	table[4][1] = percentile(90);
+
+	table[5][0] = "p99 (ms)";
+	table[5][1] = percentile(99);
+
+	table[6][0] = "Max (ms)";
+	table[6][1] = sorted.back();
+
+	table[7][0] = "Mean (ms)";
+	table[7][1] = mean;
+
+	table[8][0] = "Allocations / run";
+	table[8][1] = std::to_string(allocations / runs);
+
+	table[9][0] = "Bytes / run";
+	table[9][1] = Utils::bytesToSize((int)(bytes / runs));
+
+	std::cout << table << '\n';
+}
+
+void Compiler::enableTracing(const std::string& path)
+{
+	trace_path = path;
+	Profiler::enabled = true;
+	Profiler::tracing = true;
+}
+
+void Compiler::enableSampling(const std::string& path)
+{
+	samples_path = path;
+	Sampler::start();
+}
+
+void Compiler::enableInstrumentation()
+{
+	Instrumentation::enabled = true;
+	// Node counts must see every visit, native code would skip them.
+	Jit::enabled = false;
+}
+
+void Compiler::enableOptimizations()
+{
+	optimizer = std::make_unique<Optimizer>();
+}
+
+void Compiler::printInstrumentation(const std::string& source)
+{
+	double total = Instrumentation::total();
+	auto share = [total](double time) {
+		return total > 0.0 ? time / total * 100.0 : 0.0;
+	};
+
+	std::cout << '\n';
+	Utils::title("ANNOTATED SOURCE", 15, false);
+
+	std::stringstream lines(source);
+	std::string line;
+	int line_number = 0;
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (; std::getline(lines, line); line_number++) {
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		Instrumentation::Stat stat = { 0, 0.0 };
+
+		if ((size_t)line_number < Instrumentation::lines.size())
+			stat = Instrumentation::lines[line_number];
+
+		double percent = share(stat.self);
+
+		// Lines taking a tenth of the run or more are the ones worth rewriting.
+		if (percent >= 10.0)
+			std::cout << "\x1B[31m";
+		else if (percent >= 1.0)
+			std::cout << "\x1B[33m";
+
+		std::cout << std::setw(5) << line_number + 1 << " | ";
+
+		if (stat.hits > 0) {
+			std::cout << std::setw(10) << stat.hits << " | "
+				<< std::setw(10) << stat.self * 1000.0 << " ms | "
+				<< std::setw(6) << percent << "% | ";
+		}
+		else {
+			std::cout << std::string(10, ' ') << " | "
+				<< std::string(13, ' ') << " | "
+				<< std::string(7, ' ') << " | ";
+		}
+
+		std::cout << line << "\033[0m\n";
+	}
+
+	std::cout << std::defaultfloat;
+	std::cout.precision(std::numeric_limits<double>::max_digits10);
+
+	std::vector<std::pair<Node::Type, Instrumentation::Stat>> types;
+
+	for (int i = 0; i <= Node::Type::INDUCTION; ++i) {
+		if (Instrumentation::types[i].hits > 0)
+			types.push_back({ (Node::Type)i, Instrumentation::types[i] });
+	}
+
+	std::sort(types.begin(), types.end(), [](const auto& a, const auto& b) {
+		return a.second.self > b.second.self;
+	});
+
+	std::cout << '\n';
+	Utils::title("NODE KINDS", 15, false);
+
+	ConsoleTable table(1, 2);
+	ConsoleTable::TableChars chars;
+
+	chars.topLeft = '+';
+	chars.topRight = '+';
+	chars.downLeft = '+';
+	chars.downRight = '+';
+	chars.topDownSimple = '-';
+	chars.leftRightSimple = '|';
+	chars.leftSeparation = '+';
+	chars.rightSeparation = '+';
+	chars.centreSeparation = '+';
+	chars.topSeparation = '+';
+	chars.downSeparation = '+';
+
+	table.setTableChars(chars);
+
+	table[0][0] = "Kind";
+	table[0][1] = "Hits";
+	table[0][2] = "Self (ms)";
+	table[0][3] = "Share (%)";
+
+	Node kind(nullptr);
+
+	for (size_t i = 0; i < types.size(); ++i) {
+		kind.type = types[i].first;
+
+		table[i + 1][0] = kind.typeToStr();
+		table[i + 1][1] = std::to_string(types[i].second.hits);
+		table[i + 1][2] = types[i].second.self * 1000.0;
+		table[i + 1][3] = share(types[i].second.self);
+	}
+
+	std::cout << table << '\n';
+}
+
+void Compiler::enableMetrics(const std::string& path)
+{
+	metrics_path = path;
+}
+
+void Compiler::writeMetrics()
+{
+	auto extension = std::filesystem::path(metrics_path).extension().string();
+	auto format = extension == ".prom" || extension == ".txt"
+		? Metrics::Format::PROMETHEUS
+		: Metrics::Format::JSON;
+
+	if (!Metrics::dump(metrics_path, format))
+		std::cout << "Unable to write metrics file: " << metrics_path << '\n';
+}
+
+void Compiler::writeSamples()
+{
+	if (Sampler::write(samples_path))
+		std::cout << Sampler::total << " samples written to " << samples_path << '\n';
+	else
+		std::cout << "Unable to write samples file: " << samples_path << '\n';
+}
+
+RuntimeResult* Compiler::evaluate(Node* node)
+{
+	Allocations::Scope allocations(Allocations::Phase::EVAL);
+	Profiler profiler;
+
+	if (first_evaluation == std::chrono::steady_clock::time_point())
+		first_evaluation = std::chrono::steady_clock::now();
+
+	profiler.start = Profiler::now();
+	auto result = interpreter->visit(node, context);
+	profiler.end = Profiler::now();
+	interpreting_time = profiler.getReport();
+
+	if (Profiler::enabled)
+		Profiler::record("eval", "phase", profiler.start, profiler.end);
+
+	static auto& evaluations = Metrics::counter("bird_evaluations_total", "Top-level expressions evaluated.");
+	evaluations++;
+	Metrics::observePhase("eval", interpreting_time);
+
+	if (result != nullptr && result->error != nullptr)
+		Metrics::countError(result->error->name);
+
+	return result;
+}
+
+void Compiler::report(RuntimeResult* result, bool echo)
+{
+	if (result == nullptr)
+		return;
+
+	if (result->error != nullptr) {
+		if (strcmp(typeid(*result->error).name(), "class RuntimeError") == 0) {
+			RuntimeError* error = static_cast<RuntimeError*>(result->error);
+
+			if (error != nullptr) {
+				std::cout << error << '\n';
 			}
 		}
+		else {
+			std::cout << result->error << '\n';
+		}
+	}
+	else {
+		if (echo && result->value != nullptr) {
+			std::cout << result->value << '\n';
+		}
 	}
 }
 
@@ -120,19 +671,173 @@ void Compiler::printStatistics()
 	table.setTableChars(chars);
 
 	table[0][0] = "Step";
-	table[0][1] = "Time";
+	table[0][1] = "Time (ms)";
 
 	table[1][0] = "Tokenization";
-	table[1][1] = lexer->lexing_time;
+	table[1][1] = lexer->lexing_time * 1000.0;
 
 	table[2][0] = "Parsing";
-	table[2][1] = parser->parsing_time;
+	table[2][1] = parser->parsing_time * 1000.0;
 
 	table[3][0] = "Evaluation";
-	table[3][1] = interpreting_time;
+	table[3][1] = interpreting_time * 1000.0;
 
 	table[4][0] = "TOTAL";
-	table[4][1] = lexer->lexing_time + interpreting_time + parser->parsing_time;
+	table[4][1] = (lexer->lexing_time + interpreting_time + parser->parsing_time) * 1000.0;
+
+	std::cout << table << '\n';
+
+	if (optimizer != nullptr) {
+		Utils::title("OPTIMIZER", 15, false);
+
+		ConsoleTable optimizer_table(1, 3);
+		optimizer_table.setTableChars(chars);
+
+		optimizer_table[0][0] = "Pass";
+		optimizer_table[0][1] = "Changes";
+		optimizer_table[0][2] = "Time (ms)";
+
+		for (size_t i = 0; i < optimizer->statistics.size(); i++) {
+			auto& pass = optimizer->statistics[i];
+
+			optimizer_table[i + 1][0] = pass.name;
+			optimizer_table[i + 1][1] = std::to_string(pass.changes);
+			optimizer_table[i + 1][2] = pass.time;
+		}
+
+		std::cout << optimizer_table << '\n';
+	}
+
+	if (!Profiler::stats.empty()) {
+		Utils::title("PROFILE", 15, false);
+
+		std::vector<std::pair<std::string, Profiler::Stat>> stats(
+			Profiler::stats.begin(),
+			Profiler::stats.end()
+		);
+
+		std::sort(stats.begin(), stats.end(), [](const auto& a, const auto& b) {
+			return a.second.total > b.second.total;
+		});
+
+		ConsoleTable profile_table(1, 2);
+		profile_table.setTableChars(chars);
+
+		profile_table[0][0] = "Scope";
+		profile_table[0][1] = "Kind";
+		profile_table[0][2] = "Calls";
+		profile_table[0][3] = "Total (ms)";
+		profile_table[0][4] = "Mean (ms)";
+		profile_table[0][5] = "Max (ms)";
+
+		for (size_t i = 0; i < stats.size(); ++i) {
+			const auto& stat = stats[i].second;
+			auto row = i + 1;
+
+			profile_table[row][0] = stats[i].first;
+			profile_table[row][1] = stat.category;
+			profile_table[row][2] = std::to_string(stat.count);
+			profile_table[row][3] = stat.total * 1000.0;
+			profile_table[row][4] = stat.total / stat.count * 1000.0;
+			profile_table[row][5] = stat.max * 1000.0;
+		}
+
+		std::cout << profile_table << '\n';
+	}
+
+	Utils::title("ALLOCATIONS", 15, false);
+
+	ConsoleTable allocations_table(1, 2);
+	allocations_table.setTableChars(chars);
+
+	allocations_table[0][0] = "Kind";
+	allocations_table[0][1] = "Lex";
+	allocations_table[0][2] = "Parse";
+	allocations_table[0][3] = "Eval";
+	allocations_table[0][4] = "Bytes";
+
+	int row = 1;
+
+	for (int kind = 0; kind < Allocations::KINDS; ++kind) {
+		auto total = Allocations::total(kind);
+
+		if (total.count == 0)
+			continue;
+
+		allocations_table[row][0] = Allocations::name(kind);
+		allocations_table[row][1] = std::to_string(Allocations::stats[Allocations::Phase::LEX][kind].count);
+		allocations_table[row][2] = std::to_string(Allocations::stats[Allocations::Phase::PARSE][kind].count);
+		allocations_table[row][3] = std::to_string(Allocations::stats[Allocations::Phase::EVAL][kind].count);
+		allocations_table[row][4] = std::to_string(total.bytes);
+		row++;
+	}
+
+	std::cout << allocations_table << '\n';
+
+	if (caching) {
+		Utils::title("CACHE", 15, false);
+
+		ConsoleTable cache_table(1, 2);
+		cache_table.setTableChars(chars);
+
+		auto lookups = cache->hits + cache->misses;
+
+		cache_table[0][0] = "Metric";
+		cache_table[0][1] = "Value";
+
+		cache_table[1][0] = "Hits";
+		cache_table[1][1] = std::to_string(cache->hits);
+
+		cache_table[2][0] = "Misses";
+		cache_table[2][1] = std::to_string(cache->misses);
+
+		cache_table[3][0] = "Hit rate";
+		cache_table[3][1] = lookups > 0 ? (double)cache->hits / lookups * 100.0 : 0.0;
+
+		cache_table[4][0] = "Load time";
+		cache_table[4][1] = cache->loading_time;
+
+		std::cout << cache_table << '\n';
+	}
+}
+
+void Compiler::printStartupStatistics()
+{
+	using milliseconds = std::chrono::duration<double, std::milli>;
+
+	std::cout << '\n';
+	Utils::title("STARTUP", 15, false);
+
+	ConsoleTable table(1, 2);
+	ConsoleTable::TableChars chars;
+
+	chars.topLeft = '+';
+	chars.topRight = '+';
+	chars.downLeft = '+';
+	chars.downRight = '+';
+	chars.topDownSimple = '-';
+	chars.leftRightSimple = '|';
+	chars.leftSeparation = '+';
+	chars.rightSeparation = '+';
+	chars.centreSeparation = '+';
+	chars.topSeparation = '+';
+	chars.downSeparation = '+';
+
+	table.setTableChars(chars);
+
+	table[0][0] = "Step";
+	table[0][1] = "Time (ms)";
+
+	table[1][0] = "Compiler ready";
+	table[1][1] = milliseconds(constructed - launched).count();
+
+	table[2][0] = "First evaluation";
+	table[2][1] = first_evaluation == std::chrono::steady_clock::time_point()
+		? 0.0
+		: milliseconds(first_evaluation - launched).count();
+
+	table[3][0] = "Builtins materialized";
+	table[3][1] = std::to_string(builtins_materialized);
 
 	std::cout << table << '\n';
 }
@@ -9,7 +9,9 @@ Context::Context(
 	display_name(display_name),
 	parent(parent),
 	parent_cursor(parent_cursor),
-	symbols(nullptr)
+	symbols(nullptr),
+	coroutine(nullptr),
+	closure(nullptr)
 {
 }
 
@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "Coroutine.h"
+
+Coroutine::Coroutine(std::function<Error*(Coroutine&)> body) :
+	body(body),
+	running(false),
+	started(false),
+	finished(false),
+	cancelled(false),
+	current(nullptr),
+	failure(nullptr)
+{
+}
+
+Coroutine::~Coroutine()
+{
+	if (!started)
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if (!finished) {
+			cancelled = true;
+			running = true;
+		}
+	}
+
+	turn.notify_all();
+
+	if (thread.get_id() == std::this_thread::get_id())
+		thread.detach();
+	else
+		thread.join();
+}
+
+bool Coroutine::resume()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (finished)
+		return false;
+
+	running = true;
+
+	if (!started) {
+		started = true;
+
+		thread = std::thread([this]() {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wait(lock, true);
+			}
+
+			Error* error = nullptr;
+
+			try { error = body(*this); }
+			catch (const Cancelled&) {}
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				finished = true;
+				failure = error;
+				current = nullptr;
+				running = false;
+			}
+
+			turn.notify_all();
+		});
+	}
+	else {
+		turn.notify_all();
+	}
+
+	wait(lock, false);
+
+	return !finished;
+}
+
+void Coroutine::yield(Type* value)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	current = value;
+	running = false;
+	turn.notify_all();
+
+	wait(lock, true);
+
+	if (cancelled)
+		throw Cancelled();
+}
+
+void Coroutine::wait(std::unique_lock<std::mutex>& lock, bool body)
+{
+	turn.wait(lock, [this, body]() { return running == body; });
+}
@@ -12,4 +12,6 @@ File::File(
 	this->size = 0;
 	this->mode = mode;
 	this->closed = true;
+
+	Allocations::refine(Allocations::Kind::FILE, sizeof(File));
 }
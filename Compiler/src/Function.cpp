@@ -1,5 +1,18 @@
 #include "pch.h"
 #include "Function.h"
+#include "Profiler.h"
+#include "Coroutine.h"
+#include "Number.h"
+
+Closure::Closure(Symbols* globals) :
+	symbols(new Symbols(globals))
+{
+}
+
+Closure::~Closure()
+{
+	delete symbols;
+}
 
 Function::Function(
 	const std::string& name,
@@ -7,9 +20,11 @@ Function::Function(
 	const std::vector<std::string>& args_names,
 	std::shared_ptr<Cursor> start,
 	std::shared_ptr<Cursor> end,
-	Context* context
+	Context* context,
+	bool generator
 ) :
-	BaseFunction(name, body, args_names, start, end, context)
+	BaseFunction(name, body, args_names, start, end, context),
+	generator(generator)
 {
 	this->name = name;
 	this->body = body;
@@ -17,19 +32,37 @@ Function::Function(
 	this->start = start;
 	this->end = end;
 	this->context = context;
+
+	Allocations::refine(Allocations::Kind::FUNCTION, sizeof(Function));
 }
 
-RuntimeResult* Function::execute(const std::vector<Type*>& args, Context* context)
+RuntimeResult* Function::execute(const std::vector<Type*>& args, Context* context, bool checked)
 {
+	Profiler::Scope profile(name, "function");
 	RuntimeResult* result = new RuntimeResult();
+	int native = 0;
+
+	if (!generator && Jit::execute(this, args, native))
+		return result->success(new Number(native));
+
 	Interpreter* interpreter = new Interpreter();
 
-	auto scope = generate_context();
-	result->record(check_and_populate_arguments(this->args_names, args, scope));
+	// Called from `context`, which the traceback follows, but the body
+	// only sees its arguments, its captures and the globals.
+	auto scope = new Context(name, context, start);
+	scope->symbols = new Symbols(environment());
+	scope->closure = closure.get();
+
+	result->record(check_and_populate_arguments(this->args_names, args, scope, checked));
 
 	if (result->error != nullptr)
 		return result;
 
+	if (generator) {
+		delete interpreter;
+		return result->success(new Type(Range(start_generator(scope))));
+	}
+
 	auto body_visit = interpreter->visit(body, scope);
 	auto result_value = result->record(body_visit);
 
@@ -43,3 +76,36 @@ RuntimeResult* Function::execute(const std::vector<Type*>& args, Context* contex
 
 	return result->success(result_value);
 }
+
+Symbols* Function::environment() const
+{
+	return closure != nullptr ? closure->symbols : context->symbols;
+}
+
+std::shared_ptr<Coroutine> Function::start_generator(Context* scope)
+{
+	auto body = this->body;
+
+	// Nothing runs until the consumer pulls the first value.
+	return std::make_shared<Coroutine>([body, scope](Coroutine& coroutine) -> Error* {
+		Interpreter interpreter;
+		Error* error = nullptr;
+		scope->coroutine = &coroutine;
+
+		try {
+			auto body_visit = interpreter.visit(body, scope);
+			error = body_visit->error;
+			delete body_visit;
+		}
+		catch (const Coroutine::Cancelled&) {
+			delete scope->symbols;
+			delete scope;
+			throw;
+		}
+
+		delete scope->symbols;
+		delete scope;
+
+		return error;
+	});
+}
@@ -1,22 +1,843 @@
 #include "pch.h"
 #include "Generator.h"
 
-#include <llvm/ADT/APFloat.h>
-#include "llvm/ADT/STLExtras.h"
-#include "llvm/IR/BasicBlock.h"
-#include "llvm/IR/Constants.h"
-#include "llvm/IR/DerivedTypes.h"
-#include "llvm/IR/Function.h"
-#include "llvm/IR/IRBuilder.h"
-#include "llvm/IR/LLVMContext.h"
-#include "llvm/IR/Module.h"
-#include "llvm/IR/Type.h"
-#include "llvm/IR/Verifier.h"
-
-Generator::Generator()
-{
-	llvm::LLVMContext TheContext;
-	llvm::IRBuilder<> Builder(TheContext);
-	std::unique_ptr<llvm::Module> TheModule;
-	std::map<std::string, llvm::Value*> NamedValues;
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef PLATFORM_WINDOWS
+#include <Windows.h>
+#endif
+
+static std::string environment(const char* name, const std::string& fallback)
+{
+	auto value = std::getenv(name);
+	return value != nullptr && *value != '\0' ? value : fallback;
+}
+
+// Resolves `relative` against the directory of the running executable,
+// bin/<configuration>/Interpreter in a premake build.
+static std::string besideExecutable(const std::string& relative)
+{
+	std::filesystem::path executable;
+
+#ifdef PLATFORM_WINDOWS
+	char buffer[MAX_PATH];
+	auto length = GetModuleFileNameA(nullptr, buffer, MAX_PATH);
+
+	if (length > 0 && length < MAX_PATH)
+		executable = std::string(buffer, length);
+#else
+	std::error_code error;
+	executable = std::filesystem::read_symlink("/proc/self/exe", error);
+#endif
+
+	if (executable.empty())
+		return relative;
+
+	return (executable.parent_path() / relative).lexically_normal().string();
+}
+
+namespace {
+
+// Emits C++ for the subset Jit's Translator compiles, with the same slot
+// layout and the same checks, so the result can stand in for JIT code.
+// Arithmetic goes through unsigned ints to wrap like the interpreter.
+class Native {
+public:
+	Native(FunctionDefinitionNode* function = nullptr) :
+		function(function),
+		recursive(false),
+		variable(0),
+		counter(0),
+		end(0)
+	{
+		if (function != nullptr) {
+			for (auto arg : function->args_names)
+				slot(std::get<std::string>(arg->value));
+		}
+	}
+
+	bool loop(ForStatementNode* node, bool outermost, int depth)
+	{
+		if (node->end_value == nullptr)
+			return false;
+
+		int step = 1;
+
+		if (node->step != nullptr && !constant(node->step, step))
+			return false;
+
+		if (step == 0)
+			return false;
+
+		auto variable = slot(std::get<std::string>(node->token->value));
+		auto counter = hidden();
+		auto end = hidden();
+
+		if (outermost) {
+			this->variable = variable;
+			this->counter = counter;
+			this->end = end;
+		}
+		else {
+			std::string start, limit;
+			assigned[variable] = true;
+
+			if (!expression(node->start_value, start) || !expression(node->end_value, limit))
+				return false;
+
+			line(depth, local(counter) + " = " + start + ";");
+			line(depth, local(end) + " = " + limit + ";");
+		}
+
+		line(depth, "for (;;) {");
+		line(depth + 1, "if (" + local(counter) + (step > 0 ? " >= " : " <= ") + local(end) + ")");
+		line(depth + 2, "break;");
+		line(depth + 1, local(variable) + " = " + local(counter) + ";");
+		line(depth + 1, local(counter) + " = add32(" + local(counter) + ", " + std::to_string(step) + ");");
+
+		if (!statement(node->body, depth + 1))
+			return false;
+
+		line(depth, "}");
+		return true;
+	}
+
+	bool statement(Node* node, int depth)
+	{
+		std::string value;
+
+		switch (node->type) {
+		case Node::Type::VARIABLE_ASSIGN: {
+			if (function != nullptr || !expression(node->left, value))
+				return false;
+
+			auto index = slot(std::get<std::string>(node->token->value));
+			assigned[index] = true;
+			line(depth, local(index) + " = " + value + ";");
+
+			return true;
+		}
+		case Node::Type::FOR_STATEMENT:
+			return function == nullptr && loop((ForStatementNode*)node, false, depth);
+		case Node::Type::IF_STATEMENT: {
+			auto if_node = (IfStatementNode*)node;
+
+			for (size_t i = 0; i < if_node->cases.size(); i++) {
+				std::string test;
+
+				if (!condition(if_node->cases[i].first, test))
+					return false;
+
+				line(depth, (i == 0 ? "if (" : "else if (") + test + ") {");
+
+				if (!statement(if_node->cases[i].second, depth + 1))
+					return false;
+
+				line(depth, "}");
+			}
+
+			if (if_node->else_case != nullptr) {
+				line(depth, "else {");
+
+				if (!statement(if_node->else_case, depth + 1))
+					return false;
+
+				line(depth, "}");
+			}
+
+			return true;
+		}
+		default:
+			if (!expression(node, value))
+				return false;
+
+			line(depth, "(void)(" + value + ");");
+			return true;
+		}
+	}
+
+	bool expression(Node* node, std::string& out)
+	{
+		switch (node->type) {
+		case Node::Type::NUMERIC: {
+			auto value = std::get_if<int>(&node->token->value);
+
+			if (value == nullptr)
+				return false;
+
+			out = std::to_string(*value);
+			return true;
+		}
+		case Node::Type::VARIABLE_ACCESS: {
+			auto& name = std::get<std::string>(node->token->value);
+
+			// Functions only see their own arguments.
+			if (function != nullptr && std::find(names.begin(), names.end(), name) == names.end())
+				return false;
+
+			out = local(slot(name));
+			return true;
+		}
+		case Node::Type::UNARY: {
+			std::string operand;
+
+			if (node->token->type != Token::Type::MINUS || !expression(node->right, operand))
+				return false;
+
+			out = "negate32(" + operand + ")";
+			return true;
+		}
+		case Node::Type::BINARY: {
+			std::string left, right;
+			const char* operation;
+
+			switch (node->token->type) {
+			case Token::Type::PLUS: operation = "add32"; break;
+			case Token::Type::MINUS: operation = "subtract32"; break;
+			case Token::Type::MUL: operation = "multiply32"; break;
+			default: return false;
+			}
+
+			if (!expression(node->left, left) || !expression(node->right, right))
+				return false;
+
+			out = std::string(operation) + "(" + left + ", " + right + ")";
+			return true;
+		}
+		case Node::Type::IF_STATEMENT: {
+			auto if_node = (IfStatementNode*)node;
+
+			// As an expression an `if` needs an else, it would give null otherwise.
+			if (if_node->else_case == nullptr || !expression(if_node->else_case, out))
+				return false;
+
+			for (auto if_case = if_node->cases.rbegin(); if_case != if_node->cases.rend(); if_case++) {
+				std::string test, value;
+
+				if (!condition(if_case->first, test) || !expression(if_case->second, value))
+					return false;
+
+				out = "(" + test + " ? " + value + " : " + out + ")";
+			}
+
+			return true;
+		}
+		case Node::Type::FN_CALL:
+			return call((FunctionCallNode*)node, out);
+		case Node::Type::INVARIANT:
+		case Node::Type::INDUCTION:
+			return expression(node->left, out);
+		default:
+			return false;
+		}
+	}
+
+	// The C++ function called through `entry`, and for functions the one
+	// taking the arguments directly that recursive calls use.
+	std::string source() const
+	{
+		std::string out;
+
+		if (function != nullptr) {
+			std::string parameters, arguments;
+
+			for (unsigned int i = 0; i < names.size(); i++) {
+				parameters += std::string(i == 0 ? "" : ", ") + "int " + local(i);
+				arguments += std::string(i == 0 ? "" : ", ") + "(int)slots[" + std::to_string(i) + "]";
+			}
+
+			out += "static int " + entry + "_body(" + parameters + ")\n{\n\treturn " + body + ";\n}\n\n";
+			out += "static int " + entry + "(int64_t* slots)\n{\n";
+			out += names.empty() ? "\t(void)slots;\n" : "";
+			out += "\treturn " + entry + "_body(" + arguments + ");\n}\n\n";
+
+			return out;
+		}
+
+		out += "static int " + entry + "(int64_t* slots)\n{\n";
+
+		for (unsigned int i = 0; i < names.size(); i++)
+			out += "\tint " + local(i) + " = (int)slots[" + std::to_string(i) + "];\n";
+
+		out += "\n" + body + "\n";
+
+		for (unsigned int i = 0; i < names.size(); i++)
+			out += "\tslots[" + std::to_string(i) + "] = " + local(i) + ";\n";
+
+		return out + "\treturn 0;\n}\n\n";
+	}
+
+	FunctionDefinitionNode* function;
+	std::string entry;
+	std::string body;
+	std::vector<std::string> names;
+	std::vector<bool> assigned;
+	bool recursive;
+	unsigned int variable;
+	unsigned int counter;
+	unsigned int end;
+
+private:
+	static std::string local(unsigned int slot)
+	{
+		return "v" + std::to_string(slot);
+	}
+
+	void line(int depth, const std::string& text)
+	{
+		body += std::string(depth, '\t') + text + "\n";
+	}
+
+	unsigned int slot(const std::string& name)
+	{
+		auto found = std::find(names.begin(), names.end(), name);
+
+		if (found != names.end())
+			return (unsigned int)(found - names.begin());
+
+		names.push_back(name);
+		assigned.push_back(false);
+
+		return (unsigned int)names.size() - 1;
+	}
+
+	unsigned int hidden()
+	{
+		names.push_back("");
+		assigned.push_back(false);
+
+		return (unsigned int)names.size() - 1;
+	}
+
+	bool constant(Node* node, int& value)
+	{
+		if (node->type == Node::Type::UNARY && node->token->type == Token::Type::MINUS && constant(node->right, value)) {
+			value = -value;
+			return true;
+		}
+
+		auto number = node->type == Node::Type::NUMERIC ? std::get_if<int>(&node->token->value) : nullptr;
+
+		if (number == nullptr)
+			return false;
+
+		value = *number;
+		return true;
+	}
+
+	bool condition(Node* node, std::string& out)
+	{
+		if (node->type != Node::Type::BINARY)
+			return false;
+
+		const char* comparison;
+
+		switch (node->token->type) {
+		case Token::Type::EE: comparison = " == "; break;
+		case Token::Type::NE: comparison = " != "; break;
+		case Token::Type::LT: comparison = " < "; break;
+		case Token::Type::GT: comparison = " > "; break;
+		case Token::Type::LTE: comparison = " <= "; break;
+		case Token::Type::GTE: comparison = " >= "; break;
+		default: return false;
+		}
+
+		std::string left, right;
+
+		if (!expression(node->left, left) || !expression(node->right, right))
+			return false;
+
+		out = left + comparison + right;
+		return true;
+	}
+
+	bool call(FunctionCallNode* node, std::string& out)
+	{
+		if (function == nullptr
+			|| function->token == nullptr
+			|| node->callee->type != Node::Type::VARIABLE_ACCESS
+			|| node->callee->token->value != function->token->value
+			|| node->args_nodes.size() != function->args_names.size())
+			return false;
+
+		out = entry + "_body(";
+
+		for (size_t i = 0; i < node->args_nodes.size(); i++) {
+			std::string arg;
+
+			if (!expression(node->args_nodes[i], arg))
+				return false;
+
+			out += (i == 0 ? "" : ", ") + arg;
+		}
+
+		out += ")";
+		recursive = true;
+
+		return true;
+	}
+};
+
+}
+
+Generator::Generator() :
+	compiled(0)
+{
+#ifdef PLATFORM_WINDOWS
+	compiler = environment("CXX", "cl");
+	library = environment("BIRD_LIBRARY", besideExecutable("../Compiler/Compiler.lib"));
+#else
+	compiler = environment("CXX", "c++");
+	library = environment("BIRD_LIBRARY", besideExecutable("../Compiler/libCompiler.a"));
+#endif
+	include_directory = environment("BIRD_INCLUDE", besideExecutable("../../../Compiler/include"));
+}
+
+bool Generator::emit(const std::vector<Node*>& program, const std::string& filename, std::string& source)
+{
+	std::string statements;
+	natives.clear();
+	compiled = 0;
+
+	for (size_t i = 0; i < program.size(); i++) {
+		std::string body;
+
+		if (!node(program[i], body))
+			return false;
+
+		statements += "static Node* statement" + std::to_string(i) + "()\n{\n\treturn " + body + ";\n}\n\n";
+	}
+
+	source = "// Generated from " + filename + " by bird, do not edit.\n";
+	source += "#include \"pch.h\"\n#include \"BirdLang.h\"\n\n";
+	source += "static const char* FILENAME = " + quote(filename) + ";\n\n";
+
+	source +=
+		"static std::shared_ptr<Cursor> at(size_t index, int line, int column)\n"
+		"{\n"
+		"\treturn std::make_shared<Cursor>(index, line, column, FILENAME);\n"
+		"}\n\n"
+		"static Token* token(int type, const std::variant<double, int, char, std::string>& value, std::shared_ptr<Cursor> start, std::shared_ptr<Cursor> end)\n"
+		"{\n"
+		"\treturn new Token((Token::Type)type, value, start, end);\n"
+		"}\n\n";
+
+	if (compiled != 0) {
+		source +=
+			"static inline int add32(int a, int b) { return (int)((unsigned int)a + (unsigned int)b); }\n"
+			"static inline int subtract32(int a, int b) { return (int)((unsigned int)a - (unsigned int)b); }\n"
+			"static inline int multiply32(int a, int b) { return (int)((unsigned int)a * (unsigned int)b); }\n"
+			"static inline int negate32(int a) { return (int)(0u - (unsigned int)a); }\n\n"
+			"static Node* precompiled(ForStatementNode* loop, JitCode::Entry entry, const std::vector<std::string>& names, const std::vector<bool>& assigned, unsigned int variable, unsigned int counter, unsigned int end)\n"
+			"{\n"
+			"\tauto code = std::make_shared<JitCode>(entry);\n"
+			"\tcode->names = names;\n"
+			"\tcode->assigned = assigned;\n"
+			"\tcode->variable = variable;\n"
+			"\tcode->counter = counter;\n"
+			"\tcode->end = end;\n"
+			"\tloop->hotness.code = code;\n\n"
+			"\treturn loop;\n"
+			"}\n\n"
+			"static Node* precompiled(FunctionDefinitionNode* function, JitCode::Entry entry, bool recursive)\n"
+			"{\n"
+			"\tfunction->precompiled = std::make_shared<JitCode>(entry);\n"
+			"\tfunction->precompiled->recursive = recursive;\n\n"
+			"\treturn function;\n"
+			"}\n\n";
+
+		source += natives;
+	}
+
+	source += statements;
+	source += "int main(int argc, char** argv)\n{\n";
+	source += "\tCompiler compiler;\n";
+	source += "\tstd::vector<Node*> program;\n\n";
+
+	for (size_t i = 0; i < program.size(); i++)
+		source += "\tprogram.push_back(statement" + std::to_string(i) + "());\n";
+
+	source += "\n\tfor (auto node : program)\n\t\tNode::discard(node);\n\n";
+	source += "\treturn compiler.run(program) ? 0 : 1;\n}\n";
+
+	return true;
+}
+
+bool Generator::build(const std::string& source, const std::string& output)
+{
+	auto path = output + ".cpp";
+	std::ofstream stream(path, std::ios::binary);
+
+	if (!stream)
+		return false;
+
+	stream << source;
+	stream.close();
+
+#ifdef PLATFORM_WINDOWS
+	command = compiler + " /nologo /std:c++17 /O2 /EHsc /DPLATFORM_WINDOWS"
+		+ " /I\"" + include_directory + "\" \"" + path + "\" \"" + library + "\" /Fe:\"" + output + "\"";
+#else
+	command = compiler + " -std=c++17 -O2 -DPLATFORM_LINUX"
+		+ " -I'" + include_directory + "' '" + path + "' '" + library + "' -lpthread -o '" + output + "'";
+#endif
+
+	if (std::system(command.c_str()) != 0)
+		return false;
+
+	std::remove(path.c_str());
+	return true;
+}
+
+std::string Generator::precompile(ForStatementNode* loop)
+{
+	Native native;
+	native.entry = "loop" + std::to_string(compiled);
+
+	if (!native.loop(loop, true, 1))
+		return "";
+
+	auto strings = [](const std::vector<std::string>& values) {
+		std::string out = "{";
+
+		for (auto& value : values)
+			out += " " + quote(value) + ",";
+
+		return out + " }";
+	};
+
+	std::string flags = "{";
+
+	for (auto flag : native.assigned)
+		flags += flag ? " true," : " false,";
+
+	natives += native.source();
+	compiled++;
+
+	return ", " + native.entry + ", " + strings(native.names) + ", " + flags + " }, "
+		+ std::to_string(native.variable) + ", " + std::to_string(native.counter) + ", " + std::to_string(native.end) + ")";
+}
+
+std::string Generator::precompile(FunctionDefinitionNode* function)
+{
+	// Same restrictions as Jit::compile, an argument shadowing the function
+	// would turn self calls into calls of that argument.
+	if (function->generator)
+		return "";
+
+	for (auto arg : function->args_names) {
+		auto& name = std::get<std::string>(arg->value);
+
+		if (name.find('?') != std::string::npos || (function->token != nullptr && arg->value == function->token->value))
+			return "";
+	}
+
+	Native native(function);
+	native.entry = "function" + std::to_string(compiled);
+
+	if (!native.expression(function->body, native.body))
+		return "";
+
+	natives += native.source();
+	compiled++;
+
+	return ", " + native.entry + (native.recursive ? ", true)" : ", false)");
+}
+
+bool Generator::node(Node* node, std::string& out)
+{
+	if (node == nullptr) {
+		out += "nullptr";
+		return true;
+	}
+
+	switch (node->type) {
+	case Node::Type::NUMERIC:
+		out += "new NumericNode(" + token(node->token) + ")";
+		return true;
+	case Node::Type::STRING:
+		out += "new StringNode(" + token(node->token) + ")";
+		return true;
+	case Node::Type::VARIABLE_ACCESS:
+		out += "new VariableAccessNode(" + token(node->token) + ")";
+		return true;
+	case Node::Type::BINARY:
+		out += "new BinaryOperationNode(";
+
+		if (!this->node(node->left, out))
+			return false;
+
+		out += ", " + token(node->token) + ", ";
+
+		if (!this->node(node->right, out))
+			return false;
+
+		out += ")";
+		return true;
+	case Node::Type::UNARY:
+		out += "new UnaryOperationNode(";
+
+		if (!this->node(((UnaryOperationNode*)node)->node, out))
+			return false;
+
+		out += ", " + token(node->token) + ")";
+		return true;
+	case Node::Type::VARIABLE_ASSIGN:
+		out += "new VariableAssignmentNode(" + token(node->token) + ", ";
+
+		if (!this->node(node->left, out))
+			return false;
+
+		out += ")";
+		return true;
+	case Node::Type::INDEX_ACCESS:
+		// The positions are taken from the token.
+		out += "new IndexAccessNode(" + token(node->token) + ", ";
+
+		if (!this->node(node->left, out))
+			return false;
+
+		out += ", nullptr, nullptr)";
+		return true;
+	case Node::Type::IF_STATEMENT: {
+		auto if_node = (IfStatementNode*)node;
+		out += "new IfStatementNode(" + token(if_node->token) + ", {";
+
+		for (auto& if_case : if_node->cases) {
+			out += " { ";
+
+			if (!this->node(if_case.first, out))
+				return false;
+
+			out += ", ";
+
+			if (!this->node(if_case.second, out))
+				return false;
+
+			out += " },";
+		}
+
+		out += " }, ";
+
+		if (!this->node(if_node->else_case, out))
+			return false;
+
+		out += ")";
+		return true;
+	}
+	case Node::Type::FOR_STATEMENT: {
+		auto for_node = (ForStatementNode*)node;
+		auto install = precompile(for_node);
+
+		out += install.empty() ? "" : "precompiled(";
+		out += "new ForStatementNode(" + token(for_node->token) + ", ";
+
+		for (auto child : { for_node->start_value, for_node->end_value, for_node->step }) {
+			if (!this->node(child, out))
+				return false;
+
+			out += ", ";
+		}
+
+		if (!this->node(for_node->body, out))
+			return false;
+
+		out += ")" + install;
+		return true;
+	}
+	case Node::Type::WHILE_STATEMENT: {
+		auto while_node = (WhileStatementNode*)node;
+		out += "new WhileStatementNode(" + token(while_node->token) + ", ";
+
+		if (!this->node(while_node->condition, out))
+			return false;
+
+		out += ", ";
+
+		if (!this->node(while_node->body, out))
+			return false;
+
+		out += ")";
+		return true;
+	}
+	case Node::Type::FN_DEFINITION: {
+		auto fn_node = (FunctionDefinitionNode*)node;
+		auto install = precompile(fn_node);
+
+		out += install.empty() ? "" : "precompiled(";
+		out += "new FunctionDefinitionNode(" + tokens(fn_node->args_names) + ", ";
+
+		if (!this->node(fn_node->body, out))
+			return false;
+
+		out += ", " + token(fn_node->token) + (fn_node->generator ? ", true)" : ", false)") + install;
+		return true;
+	}
+	case Node::Type::FN_CALL: {
+		auto call_node = (FunctionCallNode*)node;
+		out += "new FunctionCallNode(" + token(call_node->token) + ", ";
+
+		if (!this->node(call_node->callee, out))
+			return false;
+
+		out += ", std::vector<Node*>{";
+
+		for (auto arg : call_node->args_nodes) {
+			out += " ";
+
+			if (!this->node(arg, out))
+				return false;
+
+			out += ",";
+		}
+
+		out += " })";
+		return true;
+	}
+	case Node::Type::ARRAY: {
+		auto array_node = (ArrayNode*)node;
+		out += "new ArrayNode(" + token(array_node->token) + ", std::vector<Node*>{";
+
+		for (auto element : array_node->elements) {
+			out += " ";
+
+			if (!this->node(element, out))
+				return false;
+
+			out += ",";
+		}
+
+		out += " })";
+		return true;
+	}
+	case Node::Type::MAP: {
+		auto map_node = (MapNode*)node;
+		out += "new MapNode(" + token(map_node->token) + ", std::vector<std::pair<std::string, Node*>>{";
+
+		for (auto& element : map_node->elements) {
+			out += " { " + quote(element.first) + ", ";
+
+			if (!this->node(element.second, out))
+				return false;
+
+			out += " },";
+		}
+
+		out += " })";
+		return true;
+	}
+	case Node::Type::PROPERTY_ACCESS: {
+		auto property_node = (PropertyAccessNode*)node;
+		out += "new PropertyAccessNode(" + token(property_node->token) + ", "
+			+ quote(property_node->var_name) + ", " + tokens(property_node->path) + ")";
+		return true;
+	}
+	case Node::Type::PROPERTY_ASSIGN:
+	case Node::Type::INDEX_ASSIGN:
+		out += node->type == Node::Type::PROPERTY_ASSIGN ? "new PropertyAssignmentNode(" : "new IndexAssignmentNode(";
+		out += token(node->token) + ", ";
+
+		if (!this->node(node->left, out))
+			return false;
+
+		out += ", ";
+
+		if (!this->node(node->right, out))
+			return false;
+
+		out += ")";
+		return true;
+	case Node::Type::YIELD:
+		out += "new YieldNode(" + token(node->token) + ", ";
+
+		if (!this->node(node->left, out))
+			return false;
+
+		out += ")";
+		return true;
+	case Node::Type::INVARIANT:
+	case Node::Type::INDUCTION:
+		// Optimizer caches are not emitted, only what they compute.
+		return this->node(node->left, out);
+	default:
+		return false;
+	}
+}
+
+std::string Generator::token(Token* token)
+{
+	if (token == nullptr)
+		return "nullptr";
+
+	std::string value;
+
+	switch (token->value.index()) {
+	case 0: {
+		// Hexadecimal floats round-trip exactly.
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), "%a", std::get<double>(token->value));
+		value = std::string("(double)") + buffer;
+		break;
+	}
+	case 1:
+		value = "(int)" + std::to_string((long long)std::get<int>(token->value));
+		break;
+	case 2:
+		value = "(char)" + std::to_string((int)std::get<char>(token->value));
+		break;
+	case 3:
+		value = "std::string(" + quote(std::get<std::string>(token->value)) + ")";
+		break;
+	}
+
+	return "token(" + std::to_string((int)token->type) + ", " + value + ", "
+		+ cursor(token->start) + ", " + cursor(token->end) + ")";
+}
+
+std::string Generator::cursor(std::shared_ptr<Cursor> cursor)
+{
+	if (cursor == nullptr)
+		return "nullptr";
+
+	// Like the parse cache, the source line itself is not kept.
+	return "at(" + std::to_string((long long)cursor->index) + ", " + std::to_string(cursor->line)
+		+ ", " + std::to_string(cursor->column) + ")";
+}
+
+std::string Generator::tokens(const std::vector<Token*>& tokens)
+{
+	std::string out = "std::vector<Token*>{";
+
+	for (auto part : tokens)
+		out += " " + token(part) + ",";
+
+	return out + " }";
+}
+
+std::string Generator::quote(const std::string& value)
+{
+	std::string out = "\"";
+
+	for (unsigned char c : value) {
+		switch (c) {
+		case '"': out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\n': out += "\\n"; break;
+		case '\r': out += "\\r"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			if (c < 0x20 || c >= 0x7F) {
+				// Octal escapes stop after three digits, unlike hex ones.
+				char buffer[8];
+				snprintf(buffer, sizeof(buffer), "\\%03o", c);
+				out += buffer;
+			}
+			else {
+				out += (char)c;
+			}
+		}
+	}
+
+	return out + "\"";
 }
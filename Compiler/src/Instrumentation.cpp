@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "Instrumentation.h"
+
+bool Instrumentation::enabled = false;
+int Instrumentation::current = -1;
+std::vector<Instrumentation::Stat> Instrumentation::lines;
+Instrumentation::Stat Instrumentation::types[Node::Type::INDUCTION + 1] = {};
+std::vector<double> Instrumentation::children;
+
+Instrumentation::Visit::Visit(Node* node) :
+	node(node),
+	line(node->line()),
+	previous(current)
+{
+	// Nodes built without a cursor belong to the line of their parent.
+	if (line < 0)
+		line = current;
+
+	current = line;
+	children.push_back(0.0);
+	start = Clock::now();
+}
+
+Instrumentation::Visit::~Visit()
+{
+	double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	double self = elapsed - children.back();
+
+	children.pop_back();
+
+	if (!children.empty())
+		children.back() += elapsed;
+
+	Stat& type = types[node->type];
+	type.hits++;
+	type.self += self;
+
+	current = previous;
+
+	if (line < 0)
+		return;
+
+	if ((size_t)line >= lines.size())
+		lines.resize(line + 1, Stat{ 0, 0.0 });
+
+	lines[line].hits++;
+	lines[line].self += self;
+}
+
+void Instrumentation::reset()
+{
+	lines.clear();
+	children.clear();
+	current = -1;
+
+	for (auto& type : types)
+		type = Stat{ 0, 0.0 };
+}
+
+double Instrumentation::total()
+{
+	double total = 0.0;
+
+	for (auto& type : types)
+		total += type.self;
+
+	return total;
+}
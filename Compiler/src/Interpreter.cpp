@@ -1,16 +1,32 @@
 #include "pch.h"
 #include "Interpreter.h"
+#include "Coroutine.h"
 #include "Function.h"
 #include "Str.h"
 #include "Array.h"
 #include "Map.h"
 #include "File.h"
+#include "Sampler.h"
+#include "Instrumentation.h"
 
 Interpreter::Interpreter()
 {
 }
 
 RuntimeResult* Interpreter::visit(Node* node, Context* context)
+{
+	if (node != nullptr && Sampler::ticks.load(std::memory_order_relaxed) != 0)
+		Sampler::sample(node->line());
+
+	if (node != nullptr && Instrumentation::enabled) {
+		Instrumentation::Visit visit(node);
+		return dispatch(node, context);
+	}
+
+	return dispatch(node, context);
+}
+
+RuntimeResult* Interpreter::dispatch(Node* node, Context* context)
 {
 	if (node != nullptr && context != nullptr) {
 		if (BinaryOperationNode* binary_operation_node = dynamic_cast<BinaryOperationNode*>(node)) 
@@ -43,6 +59,16 @@ RuntimeResult* Interpreter::visit(Node* node, Context* context)
 			return visit_index_access_node(index_access_node, context);
 		else if (MapNode* map_node = dynamic_cast<MapNode*>(node))
 			return visit_map_node(map_node, context);
+		else if (PropertyAssignmentNode* property_assignment_node = dynamic_cast<PropertyAssignmentNode*>(node))
+			return visit_property_assignment_node(property_assignment_node, context);
+		else if (IndexAssignmentNode* index_assignment_node = dynamic_cast<IndexAssignmentNode*>(node))
+			return visit_index_assignment_node(index_assignment_node, context);
+		else if (YieldNode* yield_node = dynamic_cast<YieldNode*>(node))
+			return visit_yield_node(yield_node, context);
+		else if (InvariantNode* invariant_node = dynamic_cast<InvariantNode*>(node))
+			return visit_invariant_node(invariant_node, context);
+		else if (InductionNode* induction_node = dynamic_cast<InductionNode*>(node))
+			return visit_induction_node(induction_node, context);
 
 		auto type = typeid(*node).name();
 
@@ -72,10 +98,143 @@ RuntimeResult* Interpreter::visit_numeric_node(Node* node, Context* context)
 	return result->success(number);
 }
 
+// The operations a node can be quickened for, with the values Number
+// computes for two ints. Arithmetic wraps like it does there.
+static bool int_arithmetic(Token::Type type, int left, int right, int& value)
+{
+	switch (type) {
+	case Token::Type::PLUS: value = (int)((unsigned int)left + (unsigned int)right); return true;
+	case Token::Type::MINUS: value = (int)((unsigned int)left - (unsigned int)right); return true;
+	case Token::Type::MUL: value = (int)((unsigned int)left * (unsigned int)right); return true;
+	case Token::Type::MOD:
+		// Cases that trap stay on the generic path.
+		if (right == 0 || right == -1)
+			return false;
+
+		value = left % right;
+		return true;
+	default: return false;
+	}
+}
+
+static bool int_comparison(Token::Type type, int left, int right, bool& value)
+{
+	switch (type) {
+	case Token::Type::EE: value = left == right; return true;
+	case Token::Type::NE: value = left != right; return true;
+	case Token::Type::LT: value = left < right; return true;
+	case Token::Type::GT: value = left > right; return true;
+	case Token::Type::LTE: value = left <= right; return true;
+	case Token::Type::GTE: value = left >= right; return true;
+	default: return false;
+	}
+}
+
+static Number* int_operation(Token::Type type, int left, int right, Context* context)
+{
+	int number = 0;
+	bool boolean = false;
+	Number* result = nullptr;
+
+	if (int_arithmetic(type, left, right, number))
+		result = new Number(number);
+	else if (int_comparison(type, left, right, boolean))
+		result = new Number(boolean);
+
+	if (result != nullptr)
+		result->context = context;
+
+	return result;
+}
+
+bool Interpreter::unboxed_int(Node* node, Context* context, int& value)
+{
+	switch (node->type) {
+	case Node::Type::NUMERIC: {
+		auto number = std::get_if<int>(&node->token->value);
+
+		if (number == nullptr)
+			return false;
+
+		value = *number;
+		return true;
+	}
+	case Node::Type::VARIABLE_ACCESS: {
+		auto capture = ((VariableAccessNode*)node)->capture;
+		DynamicType* found = capture >= 0 && context->closure != nullptr ? context->closure->slots[capture] : nullptr;
+
+		if (found == nullptr) {
+			auto it = context->symbols->get(std::get<std::string>(node->token->value));
+
+			if (it == context->symbols->symbols.end())
+				return false;
+
+			found = &it->second;
+		}
+
+		if (found->index() != Type::Native::INT)
+			return false;
+
+		value = std::get<int>(*found);
+		return true;
+	}
+	case Node::Type::BINARY: {
+		int left, right;
+
+		return ((BinaryOperationNode*)node)->quickening == Quickening::INT
+			&& unboxed_int(node->left, context, left)
+			&& unboxed_int(node->right, context, right)
+			&& int_arithmetic(node->token->type, left, right, value);
+	}
+	case Node::Type::INDEX_ACCESS: {
+		int index;
+
+		if (((IndexAccessNode*)node)->quickening != Quickening::INT || !unboxed_int(node->left, context, index))
+			return false;
+
+		auto it = context->symbols->get(std::get<std::string>(node->token->value));
+
+		if (it == context->symbols->symbols.end() || it->second.index() != Type::Native::ARRAY)
+			return false;
+
+		auto& array = std::get<ArrayStorage>(it->second);
+
+		if (array.kind() != ArrayStorage::Kind::INTS || index < 0 || index >= (int)array.size())
+			return false;
+
+		value = array.ints()[index];
+		return true;
+	}
+	case Node::Type::INVARIANT: {
+		auto invariant = (InvariantNode*)node;
+
+		if (!invariant->cached || invariant->value.index() != Type::Native::INT)
+			return false;
+
+		value = std::get<int>(invariant->value);
+		return true;
+	}
+	case Node::Type::INDUCTION:
+		value = ((InductionNode*)node)->value;
+		return true;
+	default:
+		return false;
+	}
+}
+
 RuntimeResult* Interpreter::visit_binary_operation_node(Node* node, Context* context)
 {
 	RuntimeResult* result = new RuntimeResult();
 	Type* number = nullptr;
+	auto binary = (BinaryOperationNode*)node;
+
+	// Operands that are themselves unboxable skip their visits entirely.
+	if (binary->quickening == Quickening::INT && !Instrumentation::enabled) {
+		int left, right;
+
+		if (unboxed_int(node->left, context, left) && unboxed_int(node->right, context, right))
+			return result->success(int_operation(node->token->type, left, right, context));
+	}
 
 	auto left_visit = visit(node->left, context);
 	Type* left = (Type*)result->record(left_visit);
@@ -89,6 +248,18 @@ RuntimeResult* Interpreter::visit_binary_operation_node(Node* node, Context* con
 	if (result->error != nullptr)
 		return result;
 
+	if (binary->quickening != Quickening::GENERIC) {
+		Number* quick = nullptr;
+
+		if (left->value.index() == Type::Native::INT && right->value.index() == Type::Native::INT)
+			quick = int_operation(node->token->type, std::get<int>(left->value), std::get<int>(right->value), context);
+
+		binary->quickening = quick != nullptr ? Quickening::INT : Quickening::GENERIC;
+
+		if (quick != nullptr)
+			return result->success(quick);
+	}
+
 	Error* error = nullptr;
 
 	std::string value;
@@ -226,27 +397,39 @@ RuntimeResult* Interpreter::visit_variable_access_node(Node* node, Context* cont
 
 	auto var_name = n->token->value;
 	auto name = std::get<std::string>(var_name);
-	auto value = context->symbols->get(name);
+	DynamicType* found = nullptr;
+
+	// Captured names are read from their closure slot, no lookup.
+	if (n->capture >= 0 && context->closure != nullptr)
+		found = context->closure->slots[n->capture];
 
-	if (value == context->symbols->symbols.end()) {
-		return result->failure(new RuntimeError(n->start, n->end, "'" + name + "' is not defined", context));
+	if (found == nullptr) {
+		auto value = context->symbols->get(name);
+
+		if (value == context->symbols->symbols.end()) {
+			return result->failure(new RuntimeError(n->start, n->end, "'" + name + "' is not defined", context));
+		}
+
+		found = &value->second;
 	}
 
-	switch (value->second.index()) {
+	switch (found->index()) {
 	default:
 	case Type::Native::DOUBLE:
 	case Type::Native::INT:
 	case Type::Native::BOOL:
-		return result->success(new Number(value->second));
+		return result->success(new Number(*found));
 	case Type::Native::STRING:
-		return result->success(new String(value->second));
+		return result->success(new String(*found));
 	case Type::Native::ARRAY:
-		return result->success(new Array(std::get<std::vector<Type*>>(value->second)));
+		return result->success(new Array(*found));
 	case Type::Native::MAP:
-		return result->success(new Map(std::get<std::map<std::string, Type*>>(value->second)));
+		return result->success(new Map(*found));
+	case Type::Native::RANGE:
+		return result->success(new Type(*found));
 	case Type::Native::FILE:
 		auto file = new File();
-		auto ref = std::get<File*>(value->second);
+		auto ref = std::get<File*>(*found);
 		file->name = ref->name;
 		file->size = ref->size;
 		file->value = ref->value;
@@ -260,6 +443,11 @@ RuntimeResult* Interpreter::visit_variable_access_node(Node* node, Context* cont
 
 RuntimeResult* Interpreter::visit_variable_assignment_node(Node* node, Context* context)
 {
+	auto append = visit_string_append(node, context);
+
+	if (append != nullptr)
+		return append;
+
 	RuntimeResult* result = new RuntimeResult();
 	auto var_name = node->token->value;
 	auto number_visit = visit(node->left, context);
@@ -277,17 +465,91 @@ RuntimeResult* Interpreter::visit_variable_assignment_node(Node* node, Context*
 	else if (number->value.index() == Type::Native::FUNCTION)
 		context->symbols->set(std::get<std::string>(var_name), (Function*)std::get<Function*>(number->value));
 	else if (number->value.index() == Type::Native::STRING)
-		context->symbols->set(std::get<std::string>(var_name), std::get<std::string>(number->value));
+		context->symbols->set(std::get<std::string>(var_name), std::get<SharedString>(number->value));
 	else if (number->value.index() == Type::Native::ARRAY)
-		context->symbols->set(std::get<std::string>(var_name), std::get<std::vector<Type*>>(number->value));
+		context->symbols->set(std::get<std::string>(var_name), std::get<ArrayStorage>(number->value));
 	else if (number->value.index() == Type::Native::FILE)
 		context->symbols->set(std::get<std::string>(var_name), (File*)std::get<File*>(number->value));
 	else if (number->value.index() == Type::Native::MAP)
-		context->symbols->set(std::get<std::string>(var_name), std::get<std::map<std::string, Type*>>(number->value));
+		context->symbols->set(std::get<std::string>(var_name), std::get<MapStorage>(number->value));
+	else if (number->value.index() == Type::Native::RANGE)
+		context->symbols->set(std::get<std::string>(var_name), std::get<Range>(number->value));
 
 	return result->success(number);
 }
 
+RuntimeResult* Interpreter::visit_string_append(Node* node, Context* context)
+{
+	auto value_node = node->left;
+
+	if (value_node == nullptr
+		|| value_node->type != Node::Type::BINARY
+		|| value_node->token->type != Token::Type::PLUS
+		|| value_node->left == nullptr
+		|| value_node->left->type != Node::Type::VARIABLE_ACCESS
+		|| value_node->left->token->value != node->token->value)
+		return nullptr;
+
+	// Only a string owned by this very scope can be grown in place, an outer
+	// one would have to be shadowed by the assignment instead.
+	auto& symbols = context->symbols->symbols;
+	auto it = symbols.find(std::get<std::string>(node->token->value));
+
+	if (it == symbols.end() || it->second.index() != Type::Native::STRING)
+		return nullptr;
+
+	RuntimeResult* result = new RuntimeResult();
+	auto other_visit = visit(value_node->right, context);
+	auto other = result->record(other_visit);
+
+	if (result->error != nullptr)
+		return result;
+
+	delete other_visit;
+
+	// The right operand may have rebound the symbol, look it up again.
+	it = symbols.find(std::get<std::string>(node->token->value));
+
+	if (it == symbols.end() || it->second.index() != Type::Native::STRING) {
+		return result->failure(new RuntimeError(
+			node->start,
+			node->end,
+			"'" + std::get<std::string>(node->token->value) + "' changed type while being appended to",
+			context
+		));
+	}
+
+	auto& str = std::get<SharedString>(it->second);
+
+	switch (other->value.index()) {
+	case Type::Native::DOUBLE:
+		str.append(std::to_string(std::get<double>(other->value)));
+		break;
+	case Type::Native::INT:
+		str.append(std::to_string(std::get<int>(other->value)));
+		break;
+	case Type::Native::BOOL:
+		str.append(std::to_string(std::get<bool>(other->value)));
+		break;
+	case Type::Native::STRING:
+		str.append(std::get<SharedString>(other->value));
+		break;
+	default: {
+		// Anything else keeps the exact semantics of String::add.
+		String current(str);
+		auto added = current.add(other);
+		it->second = added.first->value;
+		delete added.first;
+		break;
+	}
+	}
+
+	if (node->discarded)
+		return result->success(nullptr);
+
+	return result->success(new String(it->second));
+}
+
 RuntimeResult* Interpreter::visit_if_statement_node(Node* node, Context* context)
 {
 	RuntimeResult* result = new RuntimeResult();
@@ -342,6 +604,9 @@ RuntimeResult* Interpreter::visit_for_statement_node(Node* node, Context* contex
 	RuntimeResult* result = new RuntimeResult();
 	auto for_node = (ForStatementNode*)node;
 
+	if (for_node->end_value == nullptr)
+		return visit_for_in_statement_node(node, context);
+
 	auto visit_start = visit(for_node->start_value, context);
 	auto start_value = result->record(visit_start);
 
@@ -395,7 +660,25 @@ RuntimeResult* Interpreter::visit_for_statement_node(Node* node, Context* contex
 	try { var_name = std::get<std::string>(for_node->token->value); }
 	catch (const std::bad_variant_access&) {}
 
+	int end_val = 0;
+	try { end_val = std::get<int>(end_value->value); }
+	catch (const std::bad_variant_access&) {}
+
+	for (auto invariant : for_node->invariants)
+		invariant->cached = false;
+
+	// Products of the loop variable follow it by addition, they wrap
+	// like the multiplication does.
+	for (auto induction : for_node->inductions) {
+		induction->value = (int)((unsigned int)increment * (unsigned int)induction->factor);
+		induction->delta = (int)((unsigned int)step_value * (unsigned int)induction->factor);
+	}
+
 	while (condition(increment)) {
+		// Once hot, the remaining iterations run natively.
+		if (Jit::enter(for_node, context->symbols, increment, end_val))
+			break;
+
 		auto num = Number(increment);
 		int num_value;
 
@@ -406,10 +689,129 @@ RuntimeResult* Interpreter::visit_for_statement_node(Node* node, Context* contex
 		increment += step_value;
 
 		auto visit_body = visit(for_node->body, context);
-		auto body_result = result->record(visit_body);
+		result->record(visit_body);
 
+		// Only the wrapper is released, the body value may be an element
+		// still held by an array or map.
+		delete visit_body;
+
+		if (result->error != nullptr)
+			return result;
+
+		for (auto induction : for_node->inductions)
+			induction->value = (int)((unsigned int)induction->value + (unsigned int)induction->delta);
+	}
+
+	return result->success(nullptr);
+}
+
+// Binds the loop variable straight from the range's source, packed
+// numbers and short strings are copied into the symbol without boxing.
+static void bind_element(Symbols* symbols, const std::string& name, const Range& range, size_t index)
+{
+	switch (range.kind()) {
+	case Range::Kind::NUMBERS:
+		symbols->set(name, range.start() + (int)index * range.step());
+		return;
+	case Range::Kind::CHARACTERS:
+		symbols->set(name, SharedString(std::get<SharedString>(range.source()).view().substr(index, 1)));
+		return;
+	default:
+		break;
+	}
+
+	if (auto array = std::get_if<ArrayStorage>(&range.source())) {
+		if (range.kind() == Range::Kind::KEYS)
+			symbols->set(name, (int)index);
+		else if (array->kind() == ArrayStorage::Kind::INTS)
+			symbols->set(name, array->ints()[index]);
+		else if (array->kind() == ArrayStorage::Kind::DOUBLES)
+			symbols->set(name, array->doubles()[index]);
+		else if (array->boxed()[index] != nullptr)
+			symbols->set(name, array->boxed()[index]->value);
+		else
+			symbols->set(name, 0);
+
+		return;
+	}
+
+	auto& entry = std::get<MapStorage>(range.source()).entries()[index];
+
+	if (range.kind() == Range::Kind::KEYS)
+		symbols->set(name, SharedString(entry.key));
+	else
+		symbols->set(name, entry.value->value);
+}
+
+RuntimeResult* Interpreter::visit_for_in_statement_node(Node* node, Context* context)
+{
+	RuntimeResult* result = new RuntimeResult();
+	auto for_node = (ForStatementNode*)node;
+
+	auto iterable = result->record(visit(for_node->start_value, context));
+
+	if (result->error != nullptr)
+		return result;
+
+	// Arrays iterate their values, maps their keys and strings their
+	// characters, through the same lazy view keys/values/chars return.
+	Range range(0, 0);
+
+	switch (iterable != nullptr ? iterable->value.index() : (size_t)Type::Native::OBJECT) {
+	case Type::Native::RANGE:
+		range = std::get<Range>(iterable->value);
+		break;
+	case Type::Native::ARRAY:
+		range = Range(Range::Kind::VALUES, std::get<ArrayStorage>(iterable->value));
+		break;
+	case Type::Native::MAP:
+		range = Range(Range::Kind::KEYS, std::get<MapStorage>(iterable->value));
+		break;
+	case Type::Native::STRING:
+		range = Range(Range::Kind::CHARACTERS, std::get<SharedString>(iterable->value));
+		break;
+	default:
+		return result->failure(new RuntimeError(
+			for_node->start_value->token->start,
+			for_node->start_value->token->end,
+			"Value is not iterable",
+			context
+		));
+	}
+
+	auto& var_name = std::get<std::string>(for_node->token->value);
+
+	if (range.kind() == Range::Kind::STREAM) {
+		// `range` holds its own reference, the stream stays alive even if
+		// the body reassigns the variable it came from.
+		auto stream = range.stream();
+
+		while (stream->resume()) {
+			auto value = stream->value();
+			context->symbols->set(var_name, value != nullptr ? value->value : DynamicType(0));
+
+			auto visit_body = visit(for_node->body, context);
+			result->record(visit_body);
+			delete visit_body;
+
+			if (result->error != nullptr)
+				return result;
+		}
+
+		if (stream->error() != nullptr)
+			return result->failure(stream->error());
+
+		return result->success(nullptr);
+	}
+
+	// The size is read every iteration, a body growing or shrinking the
+	// container it walks is seen by the loop.
+	for (size_t i = 0; i < range.size(); i++) {
+		bind_element(context->symbols, var_name, range, i);
+
+		auto visit_body = visit(for_node->body, context);
+		result->record(visit_body);
 		delete visit_body;
-		delete body_result;
 
 		if (result->error != nullptr)
 			return result;
@@ -423,6 +825,9 @@ RuntimeResult* Interpreter::visit_while_statement_node(Node* node, Context* cont
 	RuntimeResult* result = new RuntimeResult();
 	auto while_node = (WhileStatementNode*)node;
 
+	for (auto invariant : while_node->invariants)
+		invariant->cached = false;
+
 	while (true) {
 		auto res = visit(while_node->condition, context);
 		auto condition = result->record(res);
@@ -445,23 +850,156 @@ RuntimeResult* Interpreter::visit_while_statement_node(Node* node, Context* cont
 		if (result->error != nullptr)
 			return result;
 
+		// The condition and body values may be elements still held by an
+		// array or map, only the fresh truth value and wrappers are freed.
 		delete op_result.first;
 		delete res;
-		delete condition;
-		delete body_visit->value;
 		delete body_visit;
 	}
 
-	delete while_node;
-
 	return result->success(nullptr);
 }
 
+// Names a function body reads and writes, without descending into the
+// bodies of nested functions: their captures count as reads instead.
+struct FreeNames {
+	std::vector<std::string> reads;
+	std::vector<std::string> writes;
+	std::vector<VariableAccessNode*> accesses;
+};
+
+static void resolve_captures(FunctionDefinitionNode* node);
+
+static void collect_names(Node* node, FreeNames& names)
+{
+	if (node == nullptr)
+		return;
+
+	auto name = [node]() { return std::get<std::string>(node->token->value); };
+
+	switch (node->type) {
+	case Node::Type::VARIABLE_ACCESS:
+		names.reads.push_back(name());
+		names.accesses.push_back((VariableAccessNode*)node);
+		return;
+	case Node::Type::VARIABLE_ASSIGN:
+		names.writes.push_back(name());
+		collect_names(node->left, names);
+		return;
+	case Node::Type::INDEX_ACCESS:
+	case Node::Type::INDEX_ASSIGN:
+		names.reads.push_back(name());
+		collect_names(node->left, names);
+		collect_names(node->right, names);
+		return;
+	case Node::Type::PROPERTY_ACCESS:
+		names.reads.push_back(((PropertyAccessNode*)node)->var_name);
+		return;
+	case Node::Type::UNARY:
+		collect_names(((UnaryOperationNode*)node)->node, names);
+		return;
+	case Node::Type::IF_STATEMENT: {
+		auto if_node = (IfStatementNode*)node;
+
+		for (auto& if_case : if_node->cases) {
+			collect_names(if_case.first, names);
+			collect_names(if_case.second, names);
+		}
+
+		collect_names(if_node->else_case, names);
+		return;
+	}
+	case Node::Type::FOR_STATEMENT: {
+		auto for_node = (ForStatementNode*)node;
+		names.writes.push_back(name());
+		collect_names(for_node->start_value, names);
+		collect_names(for_node->end_value, names);
+		collect_names(for_node->step, names);
+		collect_names(for_node->body, names);
+		return;
+	}
+	case Node::Type::WHILE_STATEMENT:
+		collect_names(((WhileStatementNode*)node)->condition, names);
+		collect_names(((WhileStatementNode*)node)->body, names);
+		return;
+	case Node::Type::FN_DEFINITION: {
+		auto fn_node = (FunctionDefinitionNode*)node;
+		resolve_captures(fn_node);
+
+		if (fn_node->token != nullptr)
+			names.writes.push_back(name());
+
+		names.reads.insert(names.reads.end(), fn_node->captures.begin(), fn_node->captures.end());
+		return;
+	}
+	case Node::Type::FN_CALL: {
+		auto call_node = (FunctionCallNode*)node;
+		collect_names(call_node->callee, names);
+
+		for (auto arg : call_node->args_nodes)
+			collect_names(arg, names);
+
+		return;
+	}
+	case Node::Type::ARRAY:
+		for (auto element : ((ArrayNode*)node)->elements)
+			collect_names(element, names);
+
+		return;
+	case Node::Type::MAP:
+		for (auto& element : ((MapNode*)node)->elements)
+			collect_names(element.second, names);
+
+		return;
+	default:
+		collect_names(node->left, names);
+		collect_names(node->right, names);
+		return;
+	}
+}
+
+// Every free name gets a closure slot. Reads of names the body never
+// assigns are bound to their slot, the others may read a local later on
+// and keep looking their name up.
+static void resolve_captures(FunctionDefinitionNode* node)
+{
+	if (node->resolved)
+		return;
+
+	node->resolved = true;
+
+	FreeNames names;
+	collect_names(node->body, names);
+
+	auto contains = [](const std::vector<std::string>& list, const std::string& name) {
+		return std::find(list.begin(), list.end(), name) != list.end();
+	};
+
+	std::vector<std::string> args;
+
+	for (auto arg : node->args_names)
+		args.push_back(BaseFunction::optional_name(std::get<std::string>(arg->value)));
+
+	for (auto& name : names.reads) {
+		if (!contains(args, name) && !contains(node->captures, name))
+			node->captures.push_back(name);
+	}
+
+	for (auto access : names.accesses) {
+		auto& name = std::get<std::string>(access->token->value);
+		auto slot = std::find(node->captures.begin(), node->captures.end(), name);
+
+		if (slot != node->captures.end() && !contains(names.writes, name))
+			access->capture = (int)(slot - node->captures.begin());
+	}
+}
+
 RuntimeResult* Interpreter::visit_function_definition_node(Node* node, Context* context)
 {
 	RuntimeResult* result = new RuntimeResult();
 
 	auto fn_node = (FunctionDefinitionNode*)node;
+	resolve_captures(fn_node);
 
 	std::string fn_name;
 
@@ -479,17 +1017,59 @@ RuntimeResult* Interpreter::visit_function_definition_node(Node* node, Context*
 		args_names.push_back(str);
 	}
 
+	// Functions keep the global context, the scope they are defined in
+	// may be a call that returns before they run.
+	auto global = context;
+
+	while (global->parent != nullptr)
+		global = global->parent;
+
 	auto fn_value = new Function(
 		fn_name,
 		fn_node->body,
 		args_names,
 		nullptr,
 		nullptr,
-		context
+		global,
+		fn_node->generator
 	);
 
+	// Anonymous functions are only reachable through their value.
+	fn_value->value = (Function*)fn_value;
+	fn_value->hotness.code = fn_node->precompiled;
+
+	if (context->symbols->parent != nullptr) {
+		auto closure = std::make_shared<Closure>(global->symbols);
+		closure->slots.resize(fn_node->captures.size(), nullptr);
+
+		for (size_t i = 0; i < fn_node->captures.size(); i++) {
+			auto& name = fn_node->captures[i];
+
+			// Only call scopes are copied from, globals are read live.
+			for (auto scope = context->symbols; scope->parent != nullptr; scope = scope->parent) {
+				auto found = scope->symbols.find(name);
+
+				if (found != scope->symbols.end()) {
+					closure->symbols->set(name, found->second);
+					closure->slots[i] = &closure->symbols->symbols[name];
+					break;
+				}
+			}
+		}
+
+		fn_value->closure = closure;
+	}
+
 	if (fn_node->token != nullptr) {
 		context->symbols->set(fn_name, fn_value);
+
+		// A nested function calling itself by name captures itself.
+		auto self = std::find(fn_node->captures.begin(), fn_node->captures.end(), fn_name);
+
+		if (fn_value->closure != nullptr && self != fn_node->captures.end()) {
+			fn_value->closure->symbols->set(fn_name, fn_value);
+			fn_value->closure->slots[self - fn_node->captures.begin()] = &fn_value->closure->symbols->symbols[fn_name];
+		}
 	}
 
 	return result->success(fn_value);
@@ -499,13 +1079,47 @@ RuntimeResult* Interpreter::visit_function_call_node(Node* node, Context* contex
 {
 	RuntimeResult* result = new RuntimeResult();
 	auto fn_call = (FunctionCallNode*)node;
+	auto& cache = fn_call->cache;
 	std::vector<Type*> args;
 
-	auto visit_callee = visit(fn_call->callee, context);
-	auto to_call = result->record(visit_callee);
+	Function* to_call_value = nullptr;
+	RuntimeResult* visit_callee = nullptr;
+	Type* to_call = nullptr;
+
+	if (cache.function != nullptr
+		&& cache.version == Symbols::version
+		&& cache.closure == context->closure
+		&& !Instrumentation::enabled) {
+		to_call_value = cache.function;
+	}
+	else {
+		visit_callee = visit(fn_call->callee, context);
+		to_call = result->record(visit_callee);
 
-	if (result->error != nullptr)
-		return result;
+		if (result->error != nullptr)
+			return result;
+
+		try { to_call_value = std::get<Function*>(to_call->value); }
+		catch (const std::bad_variant_access&) {}
+
+		if (to_call_value == nullptr) {
+			return result->failure(new RuntimeError(
+				fn_call->callee->start,
+				fn_call->callee->end,
+				"Expected a function",
+				context
+			));
+		}
+
+		// Only a name is cached, looking it up has no side effects.
+		if (fn_call->callee->type == Node::Type::VARIABLE_ACCESS) {
+			Symbols::callees.insert(std::get<std::string>(fn_call->callee->token->value));
+			cache.function = to_call_value;
+			cache.closure = context->closure;
+			cache.version = Symbols::version;
+			cache.arity = SIZE_MAX;
+		}
+	}
 
 	for (auto arg : fn_call->args_nodes) {
 		auto arg_visit = visit(arg, context);
@@ -517,22 +1131,28 @@ RuntimeResult* Interpreter::visit_function_call_node(Node* node, Context* contex
 		delete arg_visit;
 	}
 
-	Function* to_call_value = nullptr;
+	auto cached = cache.function == to_call_value;
 
-	try { to_call_value = std::get<Function*>(to_call->value); }
-	catch (const std::bad_variant_access&) {}
-
-	to_call_value->context = context;
-
-	auto call_visit = to_call_value->execute(args, context);
+	Sampler::Call call(((BaseFunction*)to_call_value)->name, fn_call->callee->line());
+	auto call_visit = to_call_value->execute(args, context, cached && cache.arity == args.size());
 	auto return_value = result->record(call_visit);
 
+	if (cached && result->error == nullptr)
+		cache.arity = args.size();
+
 	delete visit_callee;
 	delete to_call;
 	delete call_visit;
 
-	if (result->error != nullptr)
+	if (result->error != nullptr) {
+		// Natives report errors without a position, blame the call site.
+		if (result->error->start == nullptr) {
+			result->error->start = fn_call->callee->token->start;
+			result->error->end = fn_call->callee->token->end;
+		}
+
 		return result;
+	}
 
 	return result->success(return_value);
 }
@@ -540,7 +1160,7 @@ RuntimeResult* Interpreter::visit_function_call_node(Node* node, Context* contex
 RuntimeResult* Interpreter::visit_string_node(Node* node, Context* context)
 {
 	RuntimeResult* result = new RuntimeResult();
-	String* str = new String(std::get<std::string>(node->token->value));
+	String* str = new String(((StringNode*)node)->value);
 
 	str->context = context;
 	str->start = node->token->start;
@@ -586,7 +1206,6 @@ RuntimeResult* Interpreter::visit_property_access_node(Node* node, Context* cont
 	if (it->second.index() == Type::Native::STRING) {
 		result_value = new String();
 
-		auto value = std::get<std::string>(it->second);
 		auto prop_value = std::get<std::string>(property_node->token->value);
 		auto constant = String::constants.find(prop_value);
 
@@ -623,7 +1242,7 @@ RuntimeResult* Interpreter::visit_property_access_node(Node* node, Context* cont
 		}
 		else if (prop_value == "data") {
 			result_value = new String();
-			result_value->value = std::get<std::string>(file->value);
+			result_value->value = std::get<SharedString>(file->value);
 		}
 		else if (prop_value == "closed") {
 			result_value = new Number();
@@ -636,84 +1255,152 @@ RuntimeResult* Interpreter::visit_property_access_node(Node* node, Context* cont
 	}
 	else if (it->second.index() == Type::Native::ARRAY) {
 		auto prop_value = std::get<std::string>(property_node->token->value);
-		auto array = std::get<std::vector<Type*>>(it->second);
+		auto& array = std::get<ArrayStorage>(it->second);
 
 		if (prop_value == "size") {
 			result_value = new Number();
 			result_value->value = (int)array.size();
 		}
-		else if (prop_value == "keys") {
-			result_value = new Array();
-			std::vector<Type*> keys = {};
+		else if (prop_value == "keys")
+			result_value = new Type(Range(Range::Kind::KEYS, array));
+		else if (prop_value == "values")
+			result_value = new Type(Range(Range::Kind::VALUES, array));
+	}
+	else if (it->second.index() == Type::Native::MAP) {
+		return follow_property_path(
+			property_node,
+			std::get<MapStorage>(it->second),
+			property_node->steps.size(),
+			context
+		);
+	}
 
-			for (int i = 0; i < array.size(); ++i)
-				keys.push_back(new Number(i));
+	return result->success(result_value);
+}
 
-			result_value->value = keys;
-		}
-		else if (prop_value == "values") {
-			result_value = new Array();
-			std::vector<Type*> keys = {};
+RuntimeResult* Interpreter::follow_property_path(
+	PropertyAccessNode* node,
+	const MapStorage& root,
+	size_t count,
+	Context* context
+)
+{
+	RuntimeResult* result = new RuntimeResult();
+	const MapStorage* map = &root;
+	Type* value = nullptr;
 
-			for (auto item : array)
-				keys.push_back(item);
+	for (size_t i = 0; i < count; i++) {
+		auto& step = node->steps[i];
 
-			result_value->value = keys;
+		if (map == nullptr) {
+			return result->failure(new RuntimeError(
+				node->path[i]->start,
+				node->path[i]->end,
+				"'" + node->steps[i - 1].key + "' is not a map",
+				context
+			));
 		}
-	}
-	else if (it->second.index() == Type::Native::MAP) {
 
-		auto it = context->symbols->get(property_node->var_name);
-		auto value = std::get<std::map<std::string, Type*>>(it->second);
+		// Entries never move within a storage, so a matching shape means
+		// the cached index still holds this key.
+		if (step.shape != map->shape()) {
+			step.index = map->indexOf(step.key, step.hash);
+			step.shape = map->shape();
+		}
 
-		result_value = find_map_recursive(
-			property_node->var_name,
-			context,
-			property_node->path,
-			value
-		);
+		if (step.index == MapStorage::NPOS) {
+			step.shape = 0;
+
+			return result->failure(new RuntimeError(
+				node->path[i]->start,
+				node->path[i]->end,
+				"'" + step.key + "' is not defined",
+				context
+			));
+		}
+
+		value = map->at(step.index);
+		map = value->is(Type::Native::MAP) ? &std::get<MapStorage>(value->value) : nullptr;
 	}
 
-	return result->success(result_value);
+	return result->success(value);
 }
 
-Type* Interpreter::find_map_recursive(
-	const std::string& needle,
-	Context* context,
-	const std::vector<Token*>& path,
-	const std::map<std::string, Type*>& object
-)
+RuntimeResult* Interpreter::visit_property_assignment_node(Node* node, Context* context)
 {
-	Type* result = nullptr;
+	auto assignment_node = (PropertyAssignmentNode*)node;
+	auto target = (PropertyAccessNode*)assignment_node->left;
+	RuntimeResult* result = new RuntimeResult();
+	auto value = result->record(visit(assignment_node->right, context));
 
-	for (auto part : path) {
-		auto search = object.find(std::get<std::string>(part->value));
+	if (result->error != nullptr)
+		return result;
 
-		if (search != object.end()) {
-			if (search->second->is(Type::Native::MAP)) {
-				result = find_map_recursive(
-					search->first,
-					context,
-					path,
-					std::get<std::map<std::string, Type*>>(search->second->value)
-				);
-			}
-			else {
-				result = search->second;
-			}
+	auto it = context->symbols->get(target->var_name);
+
+	if (it == context->symbols->symbols.end()) {
+		return result->failure(new RuntimeError(
+			node->token->start,
+			node->token->end,
+			"'" + target->var_name + "' is not defined",
+			context
+		));
+	}
+
+	if (it->second.index() != Type::Native::MAP) {
+		return result->failure(new RuntimeError(
+			node->token->start,
+			node->token->end,
+			"'" + target->var_name + "' is not a map",
+			context
+		));
+	}
+
+	// Everything but the last step names the map that gets written to.
+	auto map = &std::get<MapStorage>(it->second);
+	auto last = target->steps.size() - 1;
+
+	if (last > 0) {
+		auto parent = result->record(follow_property_path(target, *map, last, context));
+
+		if (result->error != nullptr)
+			return result;
+
+		if (!parent->is(Type::Native::MAP)) {
+			return result->failure(new RuntimeError(
+				target->path[last]->start,
+				target->path[last]->end,
+				"'" + target->steps[last - 1].key + "' is not a map",
+				context
+			));
 		}
+
+		map = &std::get<MapStorage>(parent->value);
 	}
 
-	return result;
+	map->set(target->steps[last].key, target->steps[last].hash, value);
+
+	return result->success(value);
 }
 
 RuntimeResult* Interpreter::visit_index_access_node(Node* node, Context* context)
 {
 	auto index_node = (IndexAccessNode*)node;
 	RuntimeResult* result = new RuntimeResult();
+
+	if (index_node->quickening == Quickening::INT && !Instrumentation::enabled) {
+		int element;
+
+		if (unboxed_int(node, context, element))
+			return result->success(new Number(element));
+	}
+
 	auto number_visit = visit(index_node->left, context);
 	Type* number = result->record(number_visit);
 
+	if (result->error != nullptr)
+		return result;
+
 	Type* result_value = nullptr;
 	auto var_name = std::get<std::string>(index_node->token->value);
 	auto it = context->symbols->get(var_name);
@@ -727,41 +1414,183 @@ RuntimeResult* Interpreter::visit_index_access_node(Node* node, Context* context
 		));
 	}
 
+	if (index_node->quickening != Quickening::GENERIC) {
+		auto array = std::get_if<ArrayStorage>(&it->second);
+
+		index_node->quickening = array != nullptr
+			&& array->kind() == ArrayStorage::Kind::INTS
+			&& number->value.index() == Type::Native::INT
+			? Quickening::INT
+			: Quickening::GENERIC;
+	}
+
 	if (it->second.index() == Type::Native::ARRAY) {
-		auto array = std::get<std::vector<Type*>>(it->second);
+		auto& array = std::get<ArrayStorage>(it->second);
 		auto index = array.at(std::get<int>(number->value));
 
 		result_value = index;
 	}
 	else if (it->second.index() == Type::Native::STRING) {
-		auto string = std::get<std::string>(it->second);
-		auto index = string.at(std::get<int>(number->value));
+		auto& string = std::get<SharedString>(it->second);
+		auto index = string.view().at(std::get<int>(number->value));
 
 		result_value = new String();
 		result_value->value = std::string(1, index);
 	}
+	else if (it->second.index() == Type::Native::RANGE) {
+		auto& range = std::get<Range>(it->second);
+
+		if (number->value.index() != Type::Native::INT ||
+			std::get<int>(number->value) < 0 ||
+			std::get<int>(number->value) >= (int)range.size()
+		) {
+			return result->failure(new RuntimeError(
+				index_node->left->token->start,
+				index_node->left->token->end,
+				"Index out of range",
+				context
+			));
+		}
+
+		result_value = range.at(std::get<int>(number->value));
+	}
 	else if (it->second.index() == Type::Native::MAP) {
-		switch (number->value.index()) {
-		case Type::Native::STRING:
-			auto map = std::get<std::map<std::string, Type*>>(it->second);
-			auto found = map.find(std::get<std::string>(number->value));
-			result_value = found->second;
-			break;
+		if (number->value.index() != Type::Native::STRING) {
+			return result->failure(new RuntimeError(
+				index_node->left->token->start,
+				index_node->left->token->end,
+				"Map keys must be strings",
+				context
+			));
+		}
+
+		auto& map = std::get<MapStorage>(it->second);
+		auto& key = std::get<SharedString>(number->value);
+
+		// String literal keys were hashed once at parse time.
+		if (index_node->left->type == Node::Type::STRING)
+			result_value = map.find(key, ((StringNode*)index_node->left)->hash);
+		else
+			result_value = map.find(key);
+
+		if (result_value == nullptr) {
+			return result->failure(new RuntimeError(
+				index_node->left->token->start,
+				index_node->left->token->end,
+				"Key '" + key.str() + "' is not defined",
+				context
+			));
 		}
 	}
 
 	return result->success(result_value);
 }
 
+RuntimeResult* Interpreter::visit_index_assignment_node(Node* node, Context* context)
+{
+	auto index_node = (IndexAssignmentNode*)node;
+	RuntimeResult* result = new RuntimeResult();
+	auto index = result->record(visit(index_node->left, context));
+
+	if (result->error != nullptr)
+		return result;
+
+	auto value = result->record(visit(index_node->right, context));
+
+	if (result->error != nullptr)
+		return result;
+
+	auto var_name = std::get<std::string>(index_node->token->value);
+	auto it = context->symbols->get(var_name);
+
+	if (it == context->symbols->symbols.end()) {
+		return result->failure(new RuntimeError(
+			node->token->start,
+			node->token->end,
+			"'" + var_name + "' is not defined",
+			context
+		));
+	}
+
+	if (it->second.index() == Type::Native::ARRAY) {
+		auto& array = std::get<ArrayStorage>(it->second);
+
+		if (index->value.index() != Type::Native::INT ||
+			std::get<int>(index->value) < 0 ||
+			std::get<int>(index->value) >= (int)array.size()
+		) {
+			return result->failure(new RuntimeError(
+				index_node->left->token->start,
+				index_node->left->token->end,
+				"Index out of range",
+				context
+			));
+		}
+
+		array.set(std::get<int>(index->value), value);
+	}
+	else if (it->second.index() == Type::Native::MAP) {
+		if (index->value.index() != Type::Native::STRING) {
+			return result->failure(new RuntimeError(
+				index_node->left->token->start,
+				index_node->left->token->end,
+				"Map keys must be strings",
+				context
+			));
+		}
+
+		auto& map = std::get<MapStorage>(it->second);
+		auto& key = std::get<SharedString>(index->value);
+
+		if (index_node->left->type == Node::Type::STRING)
+			map.set(key, ((StringNode*)index_node->left)->hash, value);
+		else
+			map.set(key, value);
+	}
+	else {
+		return result->failure(new RuntimeError(
+			node->token->start,
+			node->token->end,
+			"'" + var_name + "' is not an array or map",
+			context
+		));
+	}
+
+	return result->success(value);
+}
+
+RuntimeResult* Interpreter::visit_yield_node(Node* node, Context* context)
+{
+	RuntimeResult* result = new RuntimeResult();
+
+	if (context->coroutine == nullptr) {
+		return result->failure(new RuntimeError(
+			node->token->start,
+			node->token->end,
+			"'yield' outside of a generator function",
+			context
+		));
+	}
+
+	auto value = result->record(visit(node->left, context));
+
+	if (result->error != nullptr)
+		return result;
+
+	context->coroutine->yield(value);
+
+	return result->success(value);
+}
+
 RuntimeResult* Interpreter::visit_map_node(Node* node, Context* context)
 {
 	auto map_node = (MapNode*)node;
 	RuntimeResult* result = new RuntimeResult();
-	std::map<std::string, Type*> elements;
+	MapStorage elements;
 
-	for (auto it = map_node->elements.begin(); it != map_node->elements.end(); ++it) {
-		auto visit_element = visit(it->second, context);
-		elements.emplace(it->first, result->record(visit_element));
+	for (auto& element : map_node->elements) {
+		auto visit_element = visit(element.second, context);
+		elements.set(element.first, result->record(visit_element));
 
 		if (result->error != nullptr)
 			return result;
@@ -769,3 +1598,45 @@ RuntimeResult* Interpreter::visit_map_node(Node* node, Context* context)
 
 	return result->success(new Map(elements));
 }
+
+RuntimeResult* Interpreter::visit_invariant_node(Node* node, Context* context)
+{
+	RuntimeResult* result = new RuntimeResult();
+	auto invariant = (InvariantNode*)node;
+
+	if (invariant->cached) {
+		auto number = new Number(invariant->value);
+		number->context = context;
+
+		return result->success(number);
+	}
+
+	auto visit_value = visit(node->left, context);
+	auto value = result->record(visit_value);
+	delete visit_value;
+
+	if (result->error != nullptr)
+		return result;
+
+	switch (value != nullptr ? value->value.index() : (size_t)Type::Native::OBJECT) {
+	case Type::Native::DOUBLE:
+	case Type::Native::INT:
+	case Type::Native::BOOL:
+		invariant->value = value->value;
+		invariant->cached = true;
+		break;
+	default:
+		break;
+	}
+
+	return result->success(value);
+}
+
+RuntimeResult* Interpreter::visit_induction_node(Node* node, Context* context)
+{
+	RuntimeResult* result = new RuntimeResult();
+	auto number = new Number(((InductionNode*)node)->value);
+	number->context = context;
+
+	return result->success(number);
+}
@@ -0,0 +1,648 @@
+#include "pch.h"
+#include "Jit.h"
+#include "Nodes.h"
+#include "Function.h"
+#include "Symbols.h"
+#include "Context.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define JIT_X64
+#endif
+
+#ifdef PLATFORM_WINDOWS
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+bool Jit::enabled = true;
+
+JitCode::JitCode(const std::vector<uint8_t>& bytes) :
+	entry(nullptr),
+	size(0),
+	variable(0),
+	counter(0),
+	end(0),
+	recursive(false)
+{
+	// Written while writable, then flipped to executable: the region is
+	// never both at once.
+#ifdef PLATFORM_WINDOWS
+	size = bytes.size();
+	void* memory = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+
+	if (memory == nullptr)
+		return;
+
+	memcpy(memory, bytes.data(), bytes.size());
+	DWORD previous;
+
+	if (!VirtualProtect(memory, size, PAGE_EXECUTE_READ, &previous)) {
+		VirtualFree(memory, 0, MEM_RELEASE);
+		return;
+	}
+#else
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size = (bytes.size() + page - 1) / page * page;
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (memory == MAP_FAILED)
+		return;
+
+	memcpy(memory, bytes.data(), bytes.size());
+
+	if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+		munmap(memory, size);
+		return;
+	}
+#endif
+
+	entry = (Entry)memory;
+}
+
+JitCode::JitCode(Entry entry) :
+	entry(entry),
+	size(0),
+	variable(0),
+	counter(0),
+	end(0),
+	recursive(false)
+{
+}
+
+JitCode::~JitCode()
+{
+	if (entry == nullptr || size == 0)
+		return;
+
+#ifdef PLATFORM_WINDOWS
+	VirtualFree((void*)entry, 0, MEM_RELEASE);
+#else
+	munmap((void*)entry, size);
+#endif
+}
+
+namespace {
+
+// Generated code keeps the frame pointer in rbx and every value in eax,
+// operands of binary operations are spilled on the machine stack.
+class Emitter {
+public:
+	enum Condition : uint8_t {
+		EQUAL = 0x84,
+		NOT_EQUAL = 0x85,
+		LESS = 0x8C,
+		GREATER_EQUAL = 0x8D,
+		LESS_EQUAL = 0x8E,
+		GREATER = 0x8F
+	};
+
+	void byte(uint8_t value) { bytes.push_back(value); }
+
+	void bytes32(int32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+			byte((uint8_t)((uint32_t)value >> (i * 8)));
+	}
+
+	void prologue()
+	{
+		byte(0x53);                                 // push rbx
+#ifdef PLATFORM_WINDOWS
+		byte(0x48); byte(0x89); byte(0xCB);         // mov rbx, rcx
+#else
+		byte(0x48); byte(0x89); byte(0xFB);         // mov rbx, rdi
+#endif
+	}
+
+	void epilogue()
+	{
+		byte(0x5B);                                 // pop rbx
+		byte(0xC3);                                 // ret
+	}
+
+	void constant(int value) { byte(0xB8); bytes32(value); }
+	void load(unsigned int slot) { byte(0x8B); byte(0x83); bytes32(slot * 8); }
+	void store(unsigned int slot) { byte(0x89); byte(0x83); bytes32(slot * 8); }
+	void compareSlot(unsigned int slot) { byte(0x3B); byte(0x83); bytes32(slot * 8); }
+	void addConstant(int value) { byte(0x05); bytes32(value); }
+
+	void push() { byte(0x50); }
+	// Pops the left operand into eax, the right one moves to ecx.
+	void popOperands() { byte(0x89); byte(0xC1); byte(0x58); }
+
+	void add() { byte(0x01); byte(0xC8); }
+	void subtract() { byte(0x29); byte(0xC8); }
+	void multiply() { byte(0x0F); byte(0xAF); byte(0xC1); }
+	void negate() { byte(0xF7); byte(0xD8); }
+	void compare() { byte(0x39); byte(0xC8); }
+
+	// Calls the code's own entry with the frame currently on top of the
+	// machine stack, then drops that frame.
+	void callSelf(unsigned int arity)
+	{
+#ifdef PLATFORM_WINDOWS
+		byte(0x48); byte(0x89); byte(0xE1);         // mov rcx, rsp
+#else
+		byte(0x48); byte(0x89); byte(0xE7);         // mov rdi, rsp
+#endif
+		byte(0xE8);
+		bytes32(-(int32_t)(bytes.size() + 4));
+
+		byte(0x48); byte(0x81); byte(0xC4);         // add rsp, imm32
+		bytes32((int32_t)arity * 8);
+	}
+
+	// Both return the position of the displacement, bound later.
+	size_t jump(Condition condition) { byte(0x0F); byte(condition); bytes32(0); return bytes.size() - 4; }
+	size_t jump() { byte(0xE9); bytes32(0); return bytes.size() - 4; }
+
+	void jumpTo(size_t target) { byte(0xE9); bytes32((int32_t)target - (int32_t)(bytes.size() + 4)); }
+
+	void bind(size_t displacement) { patch(displacement, bytes.size()); }
+
+	void patch(size_t displacement, size_t target)
+	{
+		int32_t value = (int32_t)target - (int32_t)(displacement + 4);
+		memcpy(&bytes[displacement], &value, sizeof(value));
+	}
+
+	size_t position() const { return bytes.size(); }
+
+	std::vector<uint8_t> bytes;
+};
+
+class Translator {
+public:
+	Translator(Function* function = nullptr) :
+		function(function),
+		recursive(false),
+		variable(0),
+		counter(0),
+		end(0)
+	{
+		// Emitted first, self calls target offset 0.
+		emitter.prologue();
+
+		if (function != nullptr) {
+			for (auto& name : function->args_names)
+				slot(name);
+		}
+	}
+
+	bool loop(ForStatementNode* node, bool outermost)
+	{
+		if (node->end_value == nullptr)
+			return false;
+
+		int step = 1;
+
+		if (node->step != nullptr && !constant(node->step, step))
+			return false;
+
+		if (step == 0)
+			return false;
+
+		auto variable = slot(std::get<std::string>(node->token->value));
+		auto counter = hidden();
+		auto end = hidden();
+
+		if (outermost) {
+			this->variable = variable;
+			this->counter = counter;
+			this->end = end;
+		}
+		else {
+			assigned[variable] = true;
+
+			if (!expression(node->start_value))
+				return false;
+
+			emitter.store(counter);
+
+			if (!expression(node->end_value))
+				return false;
+
+			emitter.store(end);
+		}
+
+		// Same order as the interpreter: the variable takes the counter's
+		// value, then the counter moves on before the body runs.
+		auto head = emitter.position();
+		emitter.load(counter);
+		emitter.compareSlot(end);
+		auto exit = emitter.jump(step > 0 ? Emitter::GREATER_EQUAL : Emitter::LESS_EQUAL);
+		emitter.store(variable);
+		emitter.addConstant(step);
+		emitter.store(counter);
+
+		if (!statement(node->body))
+			return false;
+
+		emitter.jumpTo(head);
+		emitter.bind(exit);
+
+		return true;
+	}
+
+	bool statement(Node* node)
+	{
+		switch (node->type) {
+		case Node::Type::VARIABLE_ASSIGN: {
+			if (function != nullptr || !expression(node->left))
+				return false;
+
+			auto index = slot(std::get<std::string>(node->token->value));
+			assigned[index] = true;
+			emitter.store(index);
+
+			return true;
+		}
+		case Node::Type::FOR_STATEMENT:
+			return function == nullptr && loop((ForStatementNode*)node, false);
+		case Node::Type::IF_STATEMENT:
+			return branch((IfStatementNode*)node, false);
+		default:
+			return expression(node);
+		}
+	}
+
+	bool expression(Node* node)
+	{
+		switch (node->type) {
+		case Node::Type::NUMERIC: {
+			auto value = std::get_if<int>(&node->token->value);
+
+			if (value == nullptr)
+				return false;
+
+			emitter.constant(*value);
+			return true;
+		}
+		case Node::Type::VARIABLE_ACCESS: {
+			auto& name = std::get<std::string>(node->token->value);
+
+			// Functions only see their own arguments.
+			if (function != nullptr && std::find(names.begin(), names.end(), name) == names.end())
+				return false;
+
+			emitter.load(slot(name));
+			return true;
+		}
+		case Node::Type::UNARY:
+			if (node->token->type != Token::Type::MINUS || !expression(node->right))
+				return false;
+
+			emitter.negate();
+			return true;
+		case Node::Type::BINARY:
+			if (node->token->type != Token::Type::PLUS
+				&& node->token->type != Token::Type::MINUS
+				&& node->token->type != Token::Type::MUL)
+				return false;
+
+			if (!operands(node))
+				return false;
+
+			if (node->token->type == Token::Type::PLUS)
+				emitter.add();
+			else if (node->token->type == Token::Type::MINUS)
+				emitter.subtract();
+			else
+				emitter.multiply();
+
+			return true;
+		case Node::Type::IF_STATEMENT:
+			return branch((IfStatementNode*)node, true);
+		case Node::Type::FN_CALL:
+			return call((FunctionCallNode*)node);
+		case Node::Type::INVARIANT:
+		case Node::Type::INDUCTION:
+			// Interpreter caches, native code computes the expression itself.
+			return expression(node->left);
+		default:
+			return false;
+		}
+	}
+
+	std::vector<uint8_t> finish()
+	{
+		emitter.epilogue();
+		return emitter.bytes;
+	}
+
+	Function* function;
+	Emitter emitter;
+	std::vector<std::string> names;
+	std::vector<bool> assigned;
+	bool recursive;
+	// Slots of the outermost loop, its entry is set by the caller.
+	unsigned int variable;
+	unsigned int counter;
+	unsigned int end;
+
+private:
+	unsigned int slot(const std::string& name)
+	{
+		auto found = std::find(names.begin(), names.end(), name);
+
+		if (found != names.end())
+			return (unsigned int)(found - names.begin());
+
+		names.push_back(name);
+		assigned.push_back(false);
+
+		return (unsigned int)names.size() - 1;
+	}
+
+	unsigned int hidden()
+	{
+		names.push_back("");
+		assigned.push_back(false);
+
+		return (unsigned int)names.size() - 1;
+	}
+
+	bool constant(Node* node, int& value)
+	{
+		if (node->type == Node::Type::UNARY && node->token->type == Token::Type::MINUS && constant(node->right, value)) {
+			value = -value;
+			return true;
+		}
+
+		auto number = node->type == Node::Type::NUMERIC ? std::get_if<int>(&node->token->value) : nullptr;
+
+		if (number == nullptr)
+			return false;
+
+		value = *number;
+		return true;
+	}
+
+	bool operands(Node* node)
+	{
+		if (!expression(node->left))
+			return false;
+
+		emitter.push();
+
+		if (!expression(node->right))
+			return false;
+
+		emitter.popOperands();
+		return true;
+	}
+
+	// Jumps when `node` is false, returns the jump to bind.
+	bool condition(Node* node, size_t& jump)
+	{
+		if (node->type != Node::Type::BINARY)
+			return false;
+
+		Emitter::Condition otherwise;
+
+		switch (node->token->type) {
+		case Token::Type::EE: otherwise = Emitter::NOT_EQUAL; break;
+		case Token::Type::NE: otherwise = Emitter::EQUAL; break;
+		case Token::Type::LT: otherwise = Emitter::GREATER_EQUAL; break;
+		case Token::Type::GT: otherwise = Emitter::LESS_EQUAL; break;
+		case Token::Type::LTE: otherwise = Emitter::GREATER; break;
+		case Token::Type::GTE: otherwise = Emitter::LESS; break;
+		default: return false;
+		}
+
+		if (!operands(node))
+			return false;
+
+		emitter.compare();
+		jump = emitter.jump(otherwise);
+
+		return true;
+	}
+
+	// As an expression an `if` needs an else, it would give null otherwise.
+	bool branch(IfStatementNode* node, bool value)
+	{
+		if (value && node->else_case == nullptr)
+			return false;
+
+		std::vector<size_t> exits;
+
+		for (auto& if_case : node->cases) {
+			size_t next;
+
+			if (!condition(if_case.first, next))
+				return false;
+
+			if (!(value ? expression(if_case.second) : statement(if_case.second)))
+				return false;
+
+			exits.push_back(emitter.jump());
+			emitter.bind(next);
+		}
+
+		if (node->else_case != nullptr && !(value ? expression(node->else_case) : statement(node->else_case)))
+			return false;
+
+		for (auto exit : exits)
+			emitter.bind(exit);
+
+		return true;
+	}
+
+	bool call(FunctionCallNode* node)
+	{
+		if (function == nullptr
+			|| node->callee->type != Node::Type::VARIABLE_ACCESS
+			|| std::get<std::string>(node->callee->token->value) != function->name
+			|| node->args_nodes.size() != function->args_names.size())
+			return false;
+
+		// Pushed last to first, the first argument ends up on top and the
+		// frame reads in slot order.
+		for (auto arg = node->args_nodes.rbegin(); arg != node->args_nodes.rend(); arg++) {
+			if (!expression(*arg))
+				return false;
+
+			emitter.push();
+		}
+
+		emitter.callSelf((unsigned int)node->args_nodes.size());
+		recursive = true;
+
+		return true;
+	}
+};
+
+}
+
+bool Jit::supported()
+{
+#ifdef JIT_X64
+	return true;
+#else
+	return false;
+#endif
+}
+
+JitCode* Jit::compile(ForStatementNode* loop)
+{
+	if (!supported())
+		return nullptr;
+
+	Translator translator;
+
+	if (!translator.loop(loop, true))
+		return nullptr;
+
+	auto code = new JitCode(translator.finish());
+	code->names = translator.names;
+	code->assigned = translator.assigned;
+	code->variable = translator.variable;
+	code->counter = translator.counter;
+	code->end = translator.end;
+
+	return code;
+}
+
+JitCode* Jit::compile(Function* function)
+{
+	if (!supported() || function->generator)
+		return nullptr;
+
+	// An argument shadowing the function would turn self calls into calls
+	// of that argument.
+	auto& args = function->args_names;
+
+	for (auto& name : args) {
+		if (name == function->name || name.find('?') != std::string::npos)
+			return nullptr;
+	}
+
+	Translator translator(function);
+
+	if (!translator.expression(function->body))
+		return nullptr;
+
+	auto code = new JitCode(translator.finish());
+	code->names = translator.names;
+	code->assigned = translator.assigned;
+	code->recursive = translator.recursive;
+
+	return code;
+}
+
+bool Jit::reject(Hotness& hotness)
+{
+	if (++hotness.failures >= MAX_FAILURES) {
+		hotness.rejected = true;
+		hotness.code.reset();
+	}
+
+	return false;
+}
+
+bool Jit::enter(ForStatementNode* loop, Symbols* scope, int increment, int end)
+{
+	auto& hotness = loop->hotness;
+
+	if (!enabled || hotness.rejected)
+		return false;
+
+	if (hotness.code == nullptr) {
+		if (++hotness.count < LOOP_THRESHOLD)
+			return false;
+
+		auto code = compile(loop);
+
+		if (code == nullptr || !code->valid()) {
+			delete code;
+			hotness.rejected = true;
+			return false;
+		}
+
+		hotness.code.reset(code);
+	}
+
+	auto code = hotness.code;
+	std::vector<int64_t> slots(code->names.size(), 0);
+
+	for (unsigned int i = 0; i < code->names.size(); i++) {
+		if (code->names[i].empty() || i == code->variable)
+			continue;
+
+		// Written names must already live in this scope, the code would
+		// otherwise have to shadow outer ones only when the write happens.
+		auto& own = scope->symbols;
+		auto found = code->assigned[i] ? own.find(code->names[i]) : scope->get(code->names[i]);
+
+		if (found == own.end() || found->second.index() != Type::Native::INT)
+			return reject(hotness);
+
+		slots[i] = std::get<int>(found->second);
+	}
+
+	slots[code->counter] = increment;
+	slots[code->end] = end;
+
+	code->entry(slots.data());
+
+	for (unsigned int i = 0; i < code->names.size(); i++) {
+		if (code->assigned[i] || i == code->variable)
+			scope->set(code->names[i], (int)slots[i]);
+	}
+
+	return true;
+}
+
+bool Jit::execute(Function* function, const std::vector<Type*>& args, int& value)
+{
+	auto& hotness = function->hotness;
+
+	if (!enabled || hotness.rejected)
+		return false;
+
+	if (hotness.code == nullptr) {
+		if (++hotness.count < CALL_THRESHOLD)
+			return false;
+
+		auto code = compile(function);
+
+		if (code == nullptr || !code->valid()) {
+			delete code;
+			hotness.rejected = true;
+			return false;
+		}
+
+		hotness.code.reset(code);
+	}
+
+	auto code = hotness.code;
+
+	if (args.size() != function->args_names.size())
+		return reject(hotness);
+
+	std::vector<int64_t> slots(args.size(), 0);
+
+	for (unsigned int i = 0; i < args.size(); i++) {
+		if (args[i]->value.index() != Type::Native::INT)
+			return reject(hotness);
+
+		slots[i] = std::get<int>(args[i]->value);
+	}
+
+	if (code->recursive) {
+		auto environment = function->environment();
+		auto self = environment->get(function->name);
+
+		if (self == environment->symbols.end()
+			|| self->second.index() != Type::Native::FUNCTION
+			|| std::get<Function*>(self->second) != function)
+			return reject(hotness);
+	}
+
+	value = code->entry(slots.data());
+
+	return true;
+}
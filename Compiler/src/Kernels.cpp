@@ -0,0 +1,290 @@
+#include "pch.h"
+#include "Kernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+long long Kernels::sum(const int* data, size_t size)
+{
+	size_t i = 0;
+	long long total = 0;
+
+#ifdef KERNELS_SSE2
+	// Lanes are sign-extended to 64 bits before adding so large arrays of
+	// ints cannot overflow the accumulators.
+	__m128i low = _mm_setzero_si128();
+	__m128i high = _mm_setzero_si128();
+
+	for (; i + 4 <= size; i += 4) {
+		__m128i values = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i sign = _mm_srai_epi32(values, 31);
+		low = _mm_add_epi64(low, _mm_unpacklo_epi32(values, sign));
+		high = _mm_add_epi64(high, _mm_unpackhi_epi32(values, sign));
+	}
+
+	long long lanes[2];
+	_mm_storeu_si128((__m128i*)lanes, _mm_add_epi64(low, high));
+	total = lanes[0] + lanes[1];
+#endif
+
+	for (; i < size; i++)
+		total += data[i];
+
+	return total;
+}
+
+double Kernels::sum(const double* data, size_t size)
+{
+	size_t i = 0;
+	double total = 0.0;
+
+#ifdef KERNELS_SSE2
+	__m128d a = _mm_setzero_pd();
+	__m128d b = _mm_setzero_pd();
+
+	for (; i + 4 <= size; i += 4) {
+		a = _mm_add_pd(a, _mm_loadu_pd(data + i));
+		b = _mm_add_pd(b, _mm_loadu_pd(data + i + 2));
+	}
+
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(a, b));
+	total = lanes[0] + lanes[1];
+#endif
+
+	for (; i < size; i++)
+		total += data[i];
+
+	return total;
+}
+
+int Kernels::min(const int* data, size_t size)
+{
+	size_t i = 1;
+	int result = data[0];
+
+#ifdef KERNELS_SSE2
+	// SSE2 has no 32-bit min, select through a compare mask instead.
+	if (size >= 4) {
+		__m128i best = _mm_loadu_si128((const __m128i*)data);
+
+		for (i = 4; i + 4 <= size; i += 4) {
+			__m128i values = _mm_loadu_si128((const __m128i*)(data + i));
+			__m128i mask = _mm_cmplt_epi32(values, best);
+			best = _mm_or_si128(_mm_and_si128(mask, values), _mm_andnot_si128(mask, best));
+		}
+
+		int lanes[4];
+		_mm_storeu_si128((__m128i*)lanes, best);
+		result = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+	}
+#endif
+
+	for (; i < size; i++)
+		result = std::min(result, data[i]);
+
+	return result;
+}
+
+double Kernels::min(const double* data, size_t size)
+{
+	size_t i = 1;
+	double result = data[0];
+
+#ifdef KERNELS_SSE2
+	if (size >= 2) {
+		__m128d best = _mm_loadu_pd(data);
+
+		for (i = 2; i + 2 <= size; i += 2)
+			best = _mm_min_pd(best, _mm_loadu_pd(data + i));
+
+		double lanes[2];
+		_mm_storeu_pd(lanes, best);
+		result = std::min(lanes[0], lanes[1]);
+	}
+#endif
+
+	for (; i < size; i++)
+		result = std::min(result, data[i]);
+
+	return result;
+}
+
+int Kernels::max(const int* data, size_t size)
+{
+	size_t i = 1;
+	int result = data[0];
+
+#ifdef KERNELS_SSE2
+	if (size >= 4) {
+		__m128i best = _mm_loadu_si128((const __m128i*)data);
+
+		for (i = 4; i + 4 <= size; i += 4) {
+			__m128i values = _mm_loadu_si128((const __m128i*)(data + i));
+			__m128i mask = _mm_cmpgt_epi32(values, best);
+			best = _mm_or_si128(_mm_and_si128(mask, values), _mm_andnot_si128(mask, best));
+		}
+
+		int lanes[4];
+		_mm_storeu_si128((__m128i*)lanes, best);
+		result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+	}
+#endif
+
+	for (; i < size; i++)
+		result = std::max(result, data[i]);
+
+	return result;
+}
+
+double Kernels::max(const double* data, size_t size)
+{
+	size_t i = 1;
+	double result = data[0];
+
+#ifdef KERNELS_SSE2
+	if (size >= 2) {
+		__m128d best = _mm_loadu_pd(data);
+
+		for (i = 2; i + 2 <= size; i += 2)
+			best = _mm_max_pd(best, _mm_loadu_pd(data + i));
+
+		double lanes[2];
+		_mm_storeu_pd(lanes, best);
+		result = std::max(lanes[0], lanes[1]);
+	}
+#endif
+
+	for (; i < size; i++)
+		result = std::max(result, data[i]);
+
+	return result;
+}
+
+long long Kernels::dot(const int* a, const int* b, size_t size)
+{
+	// SSE2 lacks a signed 32-bit multiply, the scalar loop vectorizes well
+	// enough under optimization and keeps exact 64-bit products.
+	long long total = 0;
+
+	for (size_t i = 0; i < size; i++)
+		total += (long long)a[i] * b[i];
+
+	return total;
+}
+
+double Kernels::dot(const double* a, const double* b, size_t size)
+{
+	size_t i = 0;
+	double total = 0.0;
+
+#ifdef KERNELS_SSE2
+	__m128d x = _mm_setzero_pd();
+	__m128d y = _mm_setzero_pd();
+
+	for (; i + 4 <= size; i += 4) {
+		x = _mm_add_pd(x, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+		y = _mm_add_pd(y, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+	}
+
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(x, y));
+	total = lanes[0] + lanes[1];
+#endif
+
+	for (; i < size; i++)
+		total += a[i] * b[i];
+
+	return total;
+}
+
+bool Kernels::apply(Operation operation, const int* a, const int* b, int scalar, int* out, size_t size)
+{
+	size_t i = 0;
+
+#ifdef KERNELS_SSE2
+	if (operation == ADD || operation == SUBTRACT) {
+		__m128i constant = _mm_set1_epi32(scalar);
+		__m128i overflow = _mm_setzero_si128();
+
+		for (; i + 4 <= size; i += 4) {
+			__m128i left = _mm_loadu_si128((const __m128i*)(a + i));
+			__m128i right = b != nullptr ? _mm_loadu_si128((const __m128i*)(b + i)) : constant;
+			__m128i result;
+
+			// A lane overflowed when its sign bit disagrees with what the
+			// operands allow, the lanes wrap and are checked once at the end.
+			if (operation == ADD) {
+				result = _mm_add_epi32(left, right);
+				overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_xor_si128(left, result), _mm_xor_si128(right, result)));
+			}
+			else {
+				result = _mm_sub_epi32(left, right);
+				overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_xor_si128(left, right), _mm_xor_si128(left, result)));
+			}
+
+			_mm_storeu_si128((__m128i*)(out + i), result);
+		}
+
+		if (_mm_movemask_ps(_mm_castsi128_ps(overflow)) != 0)
+			return false;
+	}
+#endif
+
+	for (; i < size; i++) {
+		long long left = a[i];
+		long long right = b != nullptr ? b[i] : scalar;
+		long long result = 0;
+
+		switch (operation) {
+		case ADD: result = left + right; break;
+		case SUBTRACT: result = left - right; break;
+		case MULTIPLY: result = left * right; break;
+		case DIVIDE: result = right != 0 ? left / right : 0; break;
+		}
+
+		if (result < std::numeric_limits<int>::min() || result > std::numeric_limits<int>::max())
+			return false;
+
+		out[i] = (int)result;
+	}
+
+	return true;
+}
+
+void Kernels::apply(Operation operation, const double* a, const double* b, double scalar, double* out, size_t size)
+{
+	size_t i = 0;
+
+#ifdef KERNELS_SSE2
+	__m128d constant = _mm_set1_pd(scalar);
+
+	for (; i + 2 <= size; i += 2) {
+		__m128d left = _mm_loadu_pd(a + i);
+		__m128d right = b != nullptr ? _mm_loadu_pd(b + i) : constant;
+		__m128d result;
+
+		switch (operation) {
+		case ADD: result = _mm_add_pd(left, right); break;
+		case SUBTRACT: result = _mm_sub_pd(left, right); break;
+		case MULTIPLY: result = _mm_mul_pd(left, right); break;
+		default: result = _mm_div_pd(left, right); break;
+		}
+
+		_mm_storeu_pd(out + i, result);
+	}
+#endif
+
+	for (; i < size; i++) {
+		double right = b != nullptr ? b[i] : scalar;
+
+		switch (operation) {
+		case ADD: out[i] = a[i] + right; break;
+		case SUBTRACT: out[i] = a[i] - right; break;
+		case MULTIPLY: out[i] = a[i] * right; break;
+		case DIVIDE: out[i] = a[i] / right; break;
+		}
+	}
+}
@@ -2,6 +2,7 @@
 #include <sstream>
 #include "Lexer.h"
 #include "Profiler.h"
+#include "Metrics.h"
 #include "ConsoleTable.h"
 #include "Utils.h"
 
@@ -37,13 +38,14 @@ void Lexer::create_token(const Token::Type& type, char value)
 	tokens.push_back(new Token(type, value, start, cursor));
 }
 
-std::vector<Token*> Lexer::index_tokens(const std::string& str)
+std::vector<Token*> Lexer::index_tokens(const std::string& str, int line)
 {
+	Allocations::Scope allocations(Allocations::Phase::LEX);
 	Profiler profiler;
-	profiler.start = clock();
+	profiler.start = Profiler::now();
 	this->input = str;
 	tokens.clear();
-	cursor.reset(new Cursor(-1, 0, -1, filename, input));
+	cursor.reset(new Cursor(-1, line, -1, filename, input));
 	advance();
 
 	while (current_char != '\0') {
@@ -114,6 +116,7 @@ std::vector<Token*> Lexer::index_tokens(const std::string& str)
 					"'=' (after '!')"
 				);
 				
+				Metrics::countError(error->name);
 				std::cout << error << "\n";
 
 				return std::vector<Token*>();
@@ -155,9 +158,14 @@ std::vector<Token*> Lexer::index_tokens(const std::string& str)
 
 	cursor->column = (int)tokens.size();
 	tokens.push_back(new Token(Token::Type::EOL, char(0x04)));
-	profiler.end = clock();
+	profiler.end = Profiler::now();
 	lexing_time = profiler.getReport();
 
+	if (Profiler::enabled)
+		Profiler::record("lex", "phase", profiler.start, profiler.end);
+
+	Metrics::observePhase("lex", lexing_time);
+
 	if (debug) {
 		ConsoleTable table(1, 2);
 		ConsoleTable::TableChars chars;
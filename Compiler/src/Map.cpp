@@ -4,6 +4,7 @@
 Map::Map(const DynamicType& value) :
 	Type(value)
 {
+	Allocations::refine(Allocations::Kind::MAP, sizeof(Map));
 }
 
 std::pair<Type*, Error*> Map::compare_less_than(Type* other)
@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "MapStorage.h"
+
+MapStorage::MapStorage() :
+	storage(std::make_shared<Storage>())
+{
+	static uint64_t shapes = 0;
+	storage->shape = ++shapes;
+}
+
+Type* MapStorage::find(std::string_view key) const
+{
+	return find(key, hash(key));
+}
+
+Type* MapStorage::find(std::string_view key, size_t hash) const
+{
+	auto index = indexOf(key, hash);
+
+	return index == NPOS ? nullptr : storage->entries[index].value;
+}
+
+size_t MapStorage::indexOf(std::string_view key, size_t hash) const
+{
+	if (storage->slots.empty())
+		return NPOS;
+
+	auto index = storage->slots[probe(key, hash)];
+
+	return index == EMPTY ? NPOS : index;
+}
+
+void MapStorage::set(std::string_view key, Type* value)
+{
+	set(key, hash(key), value);
+}
+
+void MapStorage::set(std::string_view key, size_t key_hash, Type* value)
+{
+	// Keep the table at most 3/4 full so probe sequences stay short.
+	if ((storage->entries.size() + 1) * 4 > storage->slots.size() * 3)
+		grow();
+
+	auto slot = probe(key, key_hash);
+	auto index = storage->slots[slot];
+
+	if (index != EMPTY) {
+		storage->entries[index].value = value;
+		return;
+	}
+
+	storage->slots[slot] = (unsigned int)storage->entries.size();
+	storage->entries.push_back({ std::string(key), key_hash, value });
+}
+
+size_t MapStorage::hash(std::string_view key)
+{
+	return std::hash<std::string_view>()(key);
+}
+
+size_t MapStorage::probe(std::string_view key, size_t hash) const
+{
+	auto mask = storage->slots.size() - 1;
+	auto slot = hash & mask;
+
+	while (true) {
+		auto index = storage->slots[slot];
+
+		if (index == EMPTY)
+			return slot;
+
+		auto& entry = storage->entries[index];
+
+		if (entry.hash == hash && entry.key == key)
+			return slot;
+
+		slot = (slot + 1) & mask;
+	}
+}
+
+void MapStorage::grow()
+{
+	auto capacity = storage->slots.empty() ? 8 : storage->slots.size() * 2;
+	storage->slots.assign(capacity, EMPTY);
+
+	auto mask = capacity - 1;
+
+	for (unsigned int i = 0; i < storage->entries.size(); i++) {
+		auto slot = storage->entries[i].hash & mask;
+
+		while (storage->slots[slot] != EMPTY)
+			slot = (slot + 1) & mask;
+
+		storage->slots[slot] = i;
+	}
+}
+
+bool operator==(const MapStorage& a, const MapStorage& b)
+{
+	if (a.shares(b))
+		return true;
+
+	if (a.size() != b.size())
+		return false;
+
+	for (auto& entry : a.entries()) {
+		if (b.find(entry.key, entry.hash) != entry.value)
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,109 @@
+#include "pch.h"
+#include "Memory.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef PLATFORM_WINDOWS
+#include <Windows.h>
+#include <Psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+#ifdef PLATFORM_LINUX
+#include <sys/resource.h>
+#include <malloc.h>
+#endif
+
+static std::atomic<unsigned long long> allocations(0);
+static std::atomic<unsigned long long> allocated_bytes(0);
+static std::atomic<unsigned long long> live_bytes(0);
+
+// Size of the block as seen by the allocator, which is what is given
+// back on release, so live bytes never drift.
+static size_t usable_size(void* pointer)
+{
+#ifdef PLATFORM_WINDOWS
+	return _msize(pointer);
+#elif defined(PLATFORM_LINUX)
+	return malloc_usable_size(pointer);
+#else
+	return 0;
+#endif
+}
+
+static void* allocate(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+	void* pointer = std::malloc(size == 0 ? 1 : size);
+
+	if (pointer == nullptr)
+		throw std::bad_alloc();
+
+	live_bytes.fetch_add(usable_size(pointer), std::memory_order_relaxed);
+
+	return pointer;
+}
+
+static void release(void* pointer)
+{
+	if (pointer == nullptr)
+		return;
+
+	live_bytes.fetch_sub(usable_size(pointer), std::memory_order_relaxed);
+	std::free(pointer);
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	try { return allocate(size); }
+	catch (const std::bad_alloc&) { return nullptr; }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	try { return allocate(size); }
+	catch (const std::bad_alloc&) { return nullptr; }
+}
+
+void operator delete(void* pointer) noexcept { release(pointer); }
+void operator delete[](void* pointer) noexcept { release(pointer); }
+void operator delete(void* pointer, size_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { release(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { release(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { release(pointer); }
+
+Memory::Counters Memory::counters()
+{
+	return Counters{
+		allocations.load(std::memory_order_relaxed),
+		allocated_bytes.load(std::memory_order_relaxed),
+		live_bytes.load(std::memory_order_relaxed)
+	};
+}
+
+size_t Memory::peakResidentBytes()
+{
+#ifdef PLATFORM_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+#endif
+
+#ifdef PLATFORM_LINUX
+	struct rusage usage;
+
+	// ru_maxrss is reported in kilobytes on Linux.
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return (size_t)usage.ru_maxrss * 1024;
+#endif
+
+	return 0;
+}
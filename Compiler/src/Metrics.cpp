@@ -0,0 +1,254 @@
+#include "pch.h"
+#include "Metrics.h"
+#include "Memory.h"
+
+#include <sstream>
+#include <iomanip>
+
+// Seconds, from a microsecond up to ten seconds.
+const std::vector<double> Metrics::latency_bounds = {
+	0.000001, 0.00001, 0.0001, 0.001, 0.01, 0.1, 1.0, 10.0
+};
+
+std::map<std::string, Metrics::Family> Metrics::families;
+
+Metrics::Histogram::Histogram(const std::vector<double>& bounds) :
+	bounds(bounds),
+	buckets(bounds.size() + 1, 0),
+	sum(0.0),
+	count(0)
+{
+}
+
+void Metrics::Histogram::observe(double value)
+{
+	size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+
+	buckets[bucket]++;
+	sum += value;
+	count++;
+}
+
+static Metrics::Family& family(const std::string& name, const std::string& help, const std::string& label, bool histogram)
+{
+	auto it = Metrics::families.find(name);
+
+	if (it == Metrics::families.end()) {
+		Metrics::Family family;
+		family.help = help;
+		family.label = label;
+		family.histogram = histogram;
+
+		it = Metrics::families.emplace(name, family).first;
+	}
+
+	return it->second;
+}
+
+unsigned long long& Metrics::counter(
+	const std::string& name,
+	const std::string& help,
+	const std::string& label,
+	const std::string& value
+)
+{
+	return family(name, help, label, false).counters[value];
+}
+
+Metrics::Histogram& Metrics::histogram(
+	const std::string& name,
+	const std::string& help,
+	const std::string& label,
+	const std::string& value
+)
+{
+	auto& histograms = family(name, help, label, true).histograms;
+	auto it = histograms.find(value);
+
+	if (it == histograms.end())
+		it = histograms.emplace(value, Histogram()).first;
+
+	return it->second;
+}
+
+void Metrics::countError(const std::string& kind)
+{
+	counter("bird_errors_total", "Errors reported, by kind.", "kind", kind)++;
+}
+
+void Metrics::observePhase(const std::string& phase, double seconds)
+{
+	histogram("bird_phase_duration_seconds", "Time spent per pipeline phase.", "phase", phase).observe(seconds);
+}
+
+static std::string escape(const std::string& str)
+{
+	std::string escaped;
+
+	for (char c : str) {
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+
+		if (c == '\n')
+			escaped += "\\n";
+		else
+			escaped += c;
+	}
+
+	return escaped;
+}
+
+static std::string labels(const std::string& label, const std::string& value, const std::string& extra = "")
+{
+	std::string result;
+
+	if (!label.empty())
+		result += label + "=\"" + escape(value) + "\"";
+
+	if (!extra.empty())
+		result += (result.empty() ? "" : ",") + extra;
+
+	return result.empty() ? "" : "{" + result + "}";
+}
+
+static std::string bound(double value)
+{
+	std::ostringstream stream;
+	stream << value;
+	return stream.str();
+}
+
+static void renderPrometheus(std::ostream& out)
+{
+	auto heap = Memory::counters();
+
+	out << "# HELP bird_heap_live_bytes Bytes currently allocated on the heap.\n"
+		<< "# TYPE bird_heap_live_bytes gauge\n"
+		<< "bird_heap_live_bytes " << heap.live << '\n'
+		<< "# HELP bird_heap_allocated_bytes_total Bytes allocated on the heap since startup.\n"
+		<< "# TYPE bird_heap_allocated_bytes_total counter\n"
+		<< "bird_heap_allocated_bytes_total " << heap.bytes << '\n';
+
+	for (auto& entry : Metrics::families) {
+		auto& name = entry.first;
+		auto& family = entry.second;
+
+		out << "# HELP " << name << ' ' << family.help << '\n'
+			<< "# TYPE " << name << (family.histogram ? " histogram" : " counter") << '\n';
+
+		for (auto& series : family.counters)
+			out << name << labels(family.label, series.first) << ' ' << series.second << '\n';
+
+		for (auto& series : family.histograms) {
+			auto& histogram = series.second;
+			unsigned long long cumulative = 0;
+
+			for (size_t i = 0; i < histogram.buckets.size(); ++i) {
+				cumulative += histogram.buckets[i];
+
+				auto le = i < histogram.bounds.size() ? bound(histogram.bounds[i]) : "+Inf";
+				out << name << "_bucket" << labels(family.label, series.first, "le=\"" + le + "\"")
+					<< ' ' << cumulative << '\n';
+			}
+
+			out << name << "_sum" << labels(family.label, series.first) << ' ' << histogram.sum << '\n'
+				<< name << "_count" << labels(family.label, series.first) << ' ' << histogram.count << '\n';
+		}
+	}
+}
+
+static void renderJson(std::ostream& out)
+{
+	auto heap = Memory::counters();
+
+	out << "{\n  \"heap\": {\"live_bytes\": " << heap.live
+		<< ", \"allocated_bytes\": " << heap.bytes
+		<< ", \"allocations\": " << heap.allocations << "},\n"
+		<< "  \"metrics\": [";
+
+	bool first = true;
+
+	for (auto& entry : Metrics::families) {
+		auto& family = entry.second;
+
+		for (auto& series : family.counters) {
+			out << (first ? "\n" : ",\n") << "    {\"name\": \"" << entry.first << "\", \"type\": \"counter\", ";
+
+			if (!family.label.empty())
+				out << "\"labels\": {\"" << family.label << "\": \"" << escape(series.first) << "\"}, ";
+
+			out << "\"value\": " << series.second << "}";
+			first = false;
+		}
+
+		for (auto& series : family.histograms) {
+			auto& histogram = series.second;
+
+			out << (first ? "\n" : ",\n") << "    {\"name\": \"" << entry.first << "\", \"type\": \"histogram\", ";
+
+			if (!family.label.empty())
+				out << "\"labels\": {\"" << family.label << "\": \"" << escape(series.first) << "\"}, ";
+
+			out << "\"count\": " << histogram.count << ", \"sum\": " << histogram.sum << ", \"buckets\": [";
+
+			for (size_t i = 0; i < histogram.buckets.size(); ++i) {
+				out << (i == 0 ? "" : ", ") << "{\"le\": ";
+
+				if (i < histogram.bounds.size())
+					out << bound(histogram.bounds[i]);
+				else
+					out << "\"+Inf\"";
+
+				out << ", \"count\": " << histogram.buckets[i] << "}";
+			}
+
+			out << "]}";
+			first = false;
+		}
+	}
+
+	out << "\n  ]\n}\n";
+}
+
+std::string Metrics::render(Format format)
+{
+	std::ostringstream out;
+	out.precision(std::numeric_limits<double>::max_digits10);
+
+	if (format == Format::PROMETHEUS)
+		renderPrometheus(out);
+	else
+		renderJson(out);
+
+	return out.str();
+}
+
+bool Metrics::dump(const std::string& path, Format format)
+{
+	std::ofstream out(path, std::ios::out | std::ios::trunc);
+
+	if (!out.is_open())
+		return false;
+
+	out << render(format);
+
+	return out.good();
+}
+
+void Metrics::dump(const std::function<void(const std::string&)>& callback, Format format)
+{
+	callback(render(format));
+}
+
+void Metrics::reset()
+{
+	// Series are zeroed rather than erased, references handed out by
+	// counter() and histogram() must stay valid.
+	for (auto& entry : families) {
+		for (auto& series : entry.second.counters)
+			series.second = 0;
+
+		for (auto& series : entry.second.histograms)
+			series.second = Histogram(series.second.bounds);
+	}
+}
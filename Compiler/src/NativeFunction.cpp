@@ -2,6 +2,7 @@
 #include "NativeFunction.h"
 #include "Interpreter.h"
 #include "Str.h"
+#include "Coroutine.h"
 #include "File.h"
 #include "Array.h"
 #include "Map.h"
@@ -9,71 +10,94 @@
 #include "Utils.h"
 #include "Http.h"
 #include "Url.h"
+#include "Profiler.h"
+#include "Metrics.h"
 #include "Map.h"
-
-NativeFunction::NativeFunctionList NativeFunction::list = {
-	{"str", {{ "value" }, &NativeFunction::fn_str}},
-	{"bool", {{ "value" }, &NativeFunction::fn_bool}},
-	{"int", {{ "value" }, &NativeFunction::fn_int}},
-	{"float", {{ "value" }, &NativeFunction::fn_float}},
-
-	{"keys", {{ "value"}, &NativeFunction::fn_keys} },
-	{"values", {{ "value"}, &NativeFunction::fn_values}},
-
-	{"print", {{ "value" }, &NativeFunction::fn_print}},
-	{"sizeof", {{ "value" }, &NativeFunction::fn_sizeof}},
-	{"hsize", {{ "value" }, &NativeFunction::fn_hsize}},
-	{"typeof", {{ "value" }, &NativeFunction::fn_typeof}},
-	{"chr", {{ "string", "index" }, &NativeFunction::fn_chr}},
-
-	{"exec", {{ "command" }, &NativeFunction::fn_exec}},
-	{"open", {{ "filename", "mode?" }, &NativeFunction::fn_open}},
-
-	{"bin", {{ "value" }, &NativeFunction::fn_bin}},
-	{"hex", {{ "value" }, &NativeFunction::fn_hex}},
-	{"dec", {{ "value" }, &NativeFunction::fn_dec}},
-	{"bin", {{ "value" }, &NativeFunction::fn_bin}},
-	{"oct", {{ "value" }, &NativeFunction::fn_oct}},
-
-	{"wget", {{ "value" }, &NativeFunction::fn_wget}},
-
-	{"abs", {{ "value" }, &NativeFunction::fn_abs}},
-	{"acos", {{ "value" }, &NativeFunction::fn_acos}},
-	{"acosh", {{ "value" }, &NativeFunction::fn_acosh}},
-	{"asin", {{ "value" }, &NativeFunction::fn_asin}},
-	{"asinh", {{ "value" }, &NativeFunction::fn_asinh}},
-	{"atan", {{ "value" }, &NativeFunction::fn_atan}},
-	{"atan2", {{ "x", "y" }, &NativeFunction::fn_atan2}},
-	{"atanh", {{ "value" }, &NativeFunction::fn_atanh}},
-	{"cbrt", {{ "value" }, &NativeFunction::fn_cbrt}},
-	{"ceil", {{ "value" }, &NativeFunction::fn_ceil}},
-	{"cos", {{ "value" }, &NativeFunction::fn_cos}},
-	{"cosh", {{ "value" }, &NativeFunction::fn_cosh}},
-	{"exp", {{ "value" }, &NativeFunction::fn_exp}},
-	{"floor", {{ "value" }, &NativeFunction::fn_floor}},
-	{"log", {{ "value" }, &NativeFunction::fn_log}},
-	{"max", {{ "x", "y" }, &NativeFunction::fn_max}},
-	{"min", {{ "x", "y" }, &NativeFunction::fn_min}},
-	{"pow", {{ "n", "exp" }, &NativeFunction::fn_exp}},
-	{"random", {{}, &NativeFunction::fn_random}},
-	{"round", {{ "value" }, &NativeFunction::fn_round}},
-	{"sin", {{ "value" }, &NativeFunction::fn_sin}},
-	{"sinh", {{ "value" }, &NativeFunction::fn_sinh}},
-	{"sqrt", {{ "value" }, &NativeFunction::fn_sqrt}},
-	{"tan", {{ "value" }, &NativeFunction::fn_tan}},
-	{"tanh", {{ "value" }, &NativeFunction::fn_tanh}},
-	{"trunc", {{ "value" }, &NativeFunction::fn_trunc}}
+#include "Kernels.h"
+
+const NativeFunction::Entry NativeFunction::list[] = {
+	{"str", { "value" }, &NativeFunction::fn_str},
+	{"bool", { "value" }, &NativeFunction::fn_bool},
+	{"int", { "value" }, &NativeFunction::fn_int},
+	{"float", { "value" }, &NativeFunction::fn_float},
+
+	{"keys", { "value" }, &NativeFunction::fn_keys},
+	{"values", { "value" }, &NativeFunction::fn_values},
+	{"chars", { "value" }, &NativeFunction::fn_chars},
+	{"range", { "start", "end?", "step?" }, &NativeFunction::fn_range},
+	{"list", { "value" }, &NativeFunction::fn_list},
+	{"push", { "array", "value" }, &NativeFunction::fn_push},
+	{"pop", { "array" }, &NativeFunction::fn_pop},
+	{"insert", { "array", "index", "value" }, &NativeFunction::fn_insert},
+	{"remove", { "array", "index" }, &NativeFunction::fn_remove},
+	{"extend", { "array", "other" }, &NativeFunction::fn_extend},
+
+	{"sum", { "array" }, &NativeFunction::fn_sum},
+	{"mean", { "array" }, &NativeFunction::fn_mean},
+	{"dot", { "a", "b" }, &NativeFunction::fn_dot},
+	{"vadd", { "a", "b" }, &NativeFunction::fn_vadd},
+	{"vsub", { "a", "b" }, &NativeFunction::fn_vsub},
+	{"vmul", { "a", "b" }, &NativeFunction::fn_vmul},
+	{"vdiv", { "a", "b" }, &NativeFunction::fn_vdiv},
+
+	{"print", { "value" }, &NativeFunction::fn_print},
+	{"sizeof", { "value" }, &NativeFunction::fn_sizeof},
+	{"hsize", { "value" }, &NativeFunction::fn_hsize},
+	{"typeof", { "value" }, &NativeFunction::fn_typeof},
+	{"chr", { "string", "index" }, &NativeFunction::fn_chr},
+	{"join", { "array", "separator" }, &NativeFunction::fn_join},
+
+	{"exec", { "command" }, &NativeFunction::fn_exec},
+	{"open", { "filename", "mode?" }, &NativeFunction::fn_open},
+
+	{"bin", { "value" }, &NativeFunction::fn_bin},
+	{"hex", { "value" }, &NativeFunction::fn_hex},
+	{"dec", { "value" }, &NativeFunction::fn_dec},
+	{"oct", { "value" }, &NativeFunction::fn_oct},
+
+	{"wget", { "value" }, &NativeFunction::fn_wget},
+
+	{"abs", { "value" }, &NativeFunction::fn_abs},
+	{"acos", { "value" }, &NativeFunction::fn_acos},
+	{"acosh", { "value" }, &NativeFunction::fn_acosh},
+	{"asin", { "value" }, &NativeFunction::fn_asin},
+	{"asinh", { "value" }, &NativeFunction::fn_asinh},
+	{"atan", { "value" }, &NativeFunction::fn_atan},
+	{"atan2", { "x", "y" }, &NativeFunction::fn_atan2},
+	{"atanh", { "value" }, &NativeFunction::fn_atanh},
+	{"cbrt", { "value" }, &NativeFunction::fn_cbrt},
+	{"ceil", { "value" }, &NativeFunction::fn_ceil},
+	{"cos", { "value" }, &NativeFunction::fn_cos},
+	{"cosh", { "value" }, &NativeFunction::fn_cosh},
+	{"exp", { "value" }, &NativeFunction::fn_exp},
+	{"floor", { "value" }, &NativeFunction::fn_floor},
+	{"log", { "value" }, &NativeFunction::fn_log},
+	{"max", { "x", "y?" }, &NativeFunction::fn_max},
+	{"min", { "x", "y?" }, &NativeFunction::fn_min},
+	{"pow", { "n", "exp" }, &NativeFunction::fn_exp},
+	{"random", {}, &NativeFunction::fn_random},
+	{"round", { "value" }, &NativeFunction::fn_round},
+	{"sin", { "value" }, &NativeFunction::fn_sin},
+	{"sinh", { "value" }, &NativeFunction::fn_sinh},
+	{"sqrt", { "value" }, &NativeFunction::fn_sqrt},
+	{"tan", { "value" }, &NativeFunction::fn_tan},
+	{"tanh", { "value" }, &NativeFunction::fn_tanh},
+	{"trunc", { "value" }, &NativeFunction::fn_trunc}
 };
 
+const size_t NativeFunction::list_size = sizeof(NativeFunction::list) / sizeof(NativeFunction::list[0]);
+
 NativeFunction::NativeFunction(
 	const std::string& name,
 	Node* body,
 	const std::vector<std::string>& args_names,
 	std::shared_ptr<Cursor> start,
 	std::shared_ptr<Cursor> end,
-	Context* context
+	Context* context,
+	NativeFunctionPtr function
 ) :
-	BaseFunction(name, body, args_names, start, end, context)
+	BaseFunction(name, body, args_names, start, end, context),
+	function(function)
 {
 	this->name = name;
 	this->body = body;
@@ -81,27 +105,56 @@ NativeFunction::NativeFunction(
 	this->start = start;
 	this->end = end;
 	this->context = context;
+
+	Allocations::refine(Allocations::Kind::NATIVE_FUNCTION, sizeof(NativeFunction));
+
+	calls = &Metrics::counter("bird_native_calls_total", "Native function calls, by name.", "name", name);
+}
+
+const NativeFunction::Entry* NativeFunction::find(const std::string& name)
+{
+	for (size_t i = 0; i < list_size; i++) {
+		if (name == list[i].name)
+			return &list[i];
+	}
+
+	return nullptr;
+}
+
+NativeFunction* NativeFunction::create(const std::string& name)
+{
+	auto entry = find(name);
+
+	if (entry == nullptr)
+		return nullptr;
+
+	std::vector<std::string> args_names;
+
+	for (auto arg : entry->args_names) {
+		if (arg != nullptr)
+			args_names.push_back(arg);
+	}
+
+	return new NativeFunction(entry->name, nullptr, args_names, nullptr, nullptr, nullptr, entry->function);
 }
 
-RuntimeResult* NativeFunction::execute(const std::vector<Type*>& args, Context* context)
+RuntimeResult* NativeFunction::execute(const std::vector<Type*>& args, Context* context, bool checked)
 {
+	Profiler::Scope profile(name, "native");
 	RuntimeResult* result = new RuntimeResult();
-	auto ctx = generate_context();
+	(*calls)++;
+	// Natives read their arguments from the caller's scope.
+	this->context = context;
 
-	result->record(check_and_populate_arguments(args_names, args, context));
+	result->record(check_and_populate_arguments(args_names, args, context, checked));
 
 	if (result->error != nullptr)
 		return result;
 
 	Type* return_value = nullptr;
-	auto it = NativeFunction::list.begin();
 
-	for (; it != NativeFunction::list.end(); ++it) {
-		if (name == it->first) {
-			args_names = std::get<0>(it->second);
-			return_value = result->record(std::get<1>(it->second)(context));
-		}
-	}
+	if (function != nullptr)
+		return_value = result->record(function(context));
 
 	if (result->error != nullptr)
 		return result;
@@ -132,21 +185,24 @@ RuntimeResult* NativeFunction::fn_print(Context* ctx)
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::STRING:
-		try { std::cout << std::get<std::string>(value) << '\n'; }
+		try { std::cout << std::get<SharedString>(value) << '\n'; }
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::FILE:
-		try { std::cout << std::get<std::string>(std::get<File*>(value)->value) << '\n'; }
+		try { std::cout << std::get<SharedString>(std::get<File*>(value)->value) << '\n'; }
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::MAP:
 		try {
-			auto map = std::get<std::map<std::string, Type*>>(value);
-			auto instance = new Map(map);
+			auto instance = new Map(value);
 			std::cout << instance << std::endl;
 		}
 		catch (const std::bad_variant_access&) {}
 		break;
+	case Type::Native::RANGE:
+		try { std::cout << std::get<Range>(value).describe() << '\n'; }
+		catch (const std::bad_variant_access&) {}
+		break;
 	}
 
 	return result->success(nullptr);
@@ -168,7 +224,7 @@ RuntimeResult* NativeFunction::fn_str(Context* ctx)
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::BOOL:
-		try { string->value = (std::get<bool>(value) ? "true" : "false"); }
+		try { string->value = SharedString(std::get<bool>(value) ? "true" : "false"); }
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::FUNCTION:
@@ -176,7 +232,7 @@ RuntimeResult* NativeFunction::fn_str(Context* ctx)
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::STRING:	
-		try { string->value = std::get<std::string>(value); }
+		try { string->value = std::get<SharedString>(value); }
 		catch (const std::bad_variant_access&) {}
 		break;
 	}
@@ -184,6 +240,80 @@ RuntimeResult* NativeFunction::fn_str(Context* ctx)
 	return result->success(string);
 }
 
+RuntimeResult* NativeFunction::fn_join(Context* ctx)
+{
+	RuntimeResult* result = new RuntimeResult();
+	auto array = ctx->symbols->get("array")->second;
+	auto separator = ctx->symbols->get("separator")->second;
+
+	if (array.index() != Type::Native::ARRAY || separator.index() != Type::Native::STRING) {
+		return result->failure(new RuntimeError(
+			nullptr,
+			nullptr,
+			"join expects an array and a string separator",
+			ctx
+		));
+	}
+
+	auto& elements = std::get<ArrayStorage>(array);
+	auto& glue = std::get<SharedString>(separator);
+	auto count = elements.size();
+
+	// Non-string elements are formatted once up front, so the result can be
+	// sized exactly and filled without a single reallocation.
+	std::vector<std::string> formatted(count);
+	size_t size = count == 0 ? 0 : glue.size() * (count - 1);
+
+	for (size_t i = 0; i < count; ++i) {
+		switch (elements.kind()) {
+		case ArrayStorage::Kind::INTS:
+			formatted[i] = std::to_string(elements.ints()[i]);
+			size += formatted[i].size();
+			continue;
+		case ArrayStorage::Kind::DOUBLES:
+			formatted[i] = std::to_string(elements.doubles()[i]);
+			size += formatted[i].size();
+			continue;
+		default:
+			break;
+		}
+
+		auto& value = elements.boxed()[i]->value;
+
+		switch (value.index()) {
+		case Type::Native::DOUBLE:
+			formatted[i] = std::to_string(std::get<double>(value));
+			break;
+		case Type::Native::INT:
+			formatted[i] = std::to_string(std::get<int>(value));
+			break;
+		case Type::Native::BOOL:
+			formatted[i] = std::get<bool>(value) ? "true" : "false";
+			break;
+		case Type::Native::STRING:
+			size += std::get<SharedString>(value).size();
+			continue;
+		}
+
+		size += formatted[i].size();
+	}
+
+	SharedString joined;
+	joined.reserve(size);
+
+	for (size_t i = 0; i < count; ++i) {
+		if (i > 0)
+			joined.append(glue);
+
+		if (elements.kind() == ArrayStorage::Kind::BOXED && elements.boxed()[i]->is(Type::Native::STRING))
+			joined.append(std::get<SharedString>(elements.boxed()[i]->value));
+		else
+			joined.append(formatted[i]);
+	}
+
+	return result->success(new String(joined));
+}
+
 RuntimeResult* NativeFunction::fn_bool(Context* ctx)
 {
 	RuntimeResult* result = new RuntimeResult();
@@ -201,7 +331,7 @@ RuntimeResult* NativeFunction::fn_bool(Context* ctx)
 		break;
 	case Type::Native::STRING:
 		try {
-			auto n = std::get<std::string>(value);
+			auto n = std::get<SharedString>(value);
 			boolean->value = !n.empty() && (strcmp(n.c_str(), "true") == 0 || atoi(n.c_str()) != 0);
 		}
 		catch (const std::bad_variant_access&) {}
@@ -225,7 +355,7 @@ RuntimeResult* NativeFunction::fn_int(Context* ctx)
 		try { integer->value = std::get<int>(value); }
 		catch (const std::bad_variant_access&) {}
 	case Type::Native::STRING:
-		try { integer->value = std::stoi(std::get<std::string>(value)); }
+		try { integer->value = std::stoi(std::get<SharedString>(value).str()); }
 		catch (const std::bad_variant_access&) {}
 	}
 
@@ -246,83 +376,514 @@ RuntimeResult* NativeFunction::fn_float(Context* ctx)
 		try { number->value = (double)std::get<int>(value); }
 		catch (const std::bad_variant_access&) {}
 	case Type::Native::STRING:
-		try { number->value = std::stod(std::get<std::string>(value)); }
+		try { number->value = std::stod(std::get<SharedString>(value).str()); }
 		catch (const std::bad_variant_access&) {}
 	}
 
 	return result->success(number);
 }
 
-RuntimeResult* NativeFunction::fn_keys(Context* ctx)
+// keys, values and chars return lazy views sharing the container, the
+// elements are only read when iterated or indexed.
+static RuntimeResult* view_argument(Context* ctx, const char* native, Range::Kind kind)
 {
-	RuntimeResult* result = new RuntimeResult();
 	auto value = ctx->symbols->get("value")->second;
-	auto result_value = new Array();
-	std::vector<Type*> keys = {};
+	Range::Source source;
 
 	switch (value.index()) {
 	case Type::Native::ARRAY:
-		try {
-			auto array = std::get<std::vector<Type*>>(value);
-			auto it = array.begin();
-
-			for (int i = 0; it != array.end(); ++it, i++)
-				keys.push_back(new Number(i));
-		}
-		catch (const std::bad_variant_access&) {}
+		source = std::get<ArrayStorage>(value);
 		break;
 	case Type::Native::MAP:
-		try {
-			auto map = std::get<std::map<std::string, Type*>>(value);
-			auto it = map.begin();
-
-			for (; it != map.end(); ++it)
-				keys.push_back(new String(it->first));
-		}
-		catch (const std::bad_variant_access&) {}
+		source = std::get<MapStorage>(value);
+		break;
+	case Type::Native::STRING:
+		source = std::get<SharedString>(value);
 		break;
 	}
 
-	result_value->value = keys;
+	bool valid = kind == Range::Kind::CHARACTERS
+		? source.index() == 3
+		: source.index() == 1 || source.index() == 2;
+
+	if (!valid) {
+		return (new RuntimeResult())->failure(new RuntimeError(
+			nullptr,
+			nullptr,
+			std::string(native) + (kind == Range::Kind::CHARACTERS ? " expects a string" : " expects an array or map"),
+			ctx
+		));
+	}
+
+	return (new RuntimeResult())->success(new Type(Range(kind, source)));
+}
 
-	return result->success(result_value);
+RuntimeResult* NativeFunction::fn_keys(Context* ctx)
+{
+	return view_argument(ctx, "keys", Range::Kind::KEYS);
 }
 
 RuntimeResult* NativeFunction::fn_values(Context* ctx)
 {
-	RuntimeResult* result = new RuntimeResult();
+	return view_argument(ctx, "values", Range::Kind::VALUES);
+}
+
+RuntimeResult* NativeFunction::fn_chars(Context* ctx)
+{
+	return view_argument(ctx, "chars", Range::Kind::CHARACTERS);
+}
+
+RuntimeResult* NativeFunction::fn_range(Context* ctx)
+{
+	auto start = ctx->symbols->get("start")->second;
+	auto end = ctx->symbols->get("end")->second;
+	auto step = ctx->symbols->get("step")->second;
+
+	// range(n) counts from 0 to n.
+	if (end.index() == Type::Native::STRING) {
+		end = start;
+		start = 0;
+	}
+
+	if (step.index() == Type::Native::STRING)
+		step = 1;
+
+	if (start.index() != Type::Native::INT ||
+		end.index() != Type::Native::INT ||
+		step.index() != Type::Native::INT ||
+		std::get<int>(step) == 0
+	) {
+		return (new RuntimeResult())->failure(new RuntimeError(
+			nullptr,
+			nullptr,
+			"range expects integers and a non-zero step",
+			ctx
+		));
+	}
+
+	return (new RuntimeResult())->success(new Type(Range(std::get<int>(start), std::get<int>(end), std::get<int>(step))));
+}
+
+RuntimeResult* NativeFunction::fn_list(Context* ctx)
+{
 	auto value = ctx->symbols->get("value")->second;
-	auto result_value = new Array();
-	std::vector<Type*> values = {};
+
+	if (value.index() == Type::Native::ARRAY)
+		return (new RuntimeResult())->success(new Array(value));
+
+	Range range(0, 0);
 
 	switch (value.index()) {
-	case Type::Native::ARRAY: {
-		try {
-			auto array = std::get<std::vector<Type*>>(value);
-			auto array_it = array.begin();
+	case Type::Native::RANGE:
+		range = std::get<Range>(value);
+		break;
+	case Type::Native::MAP:
+		range = Range(Range::Kind::KEYS, std::get<MapStorage>(value));
+		break;
+	case Type::Native::STRING:
+		range = Range(Range::Kind::CHARACTERS, std::get<SharedString>(value));
+		break;
+	default:
+		return (new RuntimeResult())->failure(new RuntimeError(
+			nullptr,
+			nullptr,
+			"list expects an iterable",
+			ctx
+		));
+	}
+
+	// Generators are drained, the stream is consumed by the call.
+	if (range.kind() == Range::Kind::STREAM) {
+		auto stream = range.stream();
+		std::vector<Type*> elements;
+
+		while (stream->resume())
+			elements.push_back(stream->value());
+
+		if (stream->error() != nullptr)
+			return (new RuntimeResult())->failure(stream->error());
+
+		return (new RuntimeResult())->success(new Array(ArrayStorage(elements)));
+	}
 
-			for (; array_it != array.end(); ++array_it)
-				values.push_back(*array_it);
+	// Numeric ranges pack straight into int storage.
+	if (range.kind() == Range::Kind::NUMBERS) {
+		std::vector<int> ints(range.size());
+
+		for (size_t i = 0; i < ints.size(); i++)
+			ints[i] = range.start() + (int)i * range.step();
+
+		return (new RuntimeResult())->success(new Array(ArrayStorage(std::move(ints))));
+	}
+
+	std::vector<Type*> elements;
+	elements.reserve(range.size());
+
+	for (size_t i = 0; i < range.size(); i++)
+		elements.push_back(range.at(i));
+
+	return (new RuntimeResult())->success(new Array(ArrayStorage(elements)));
+}
+
+// The array natives below work on the caller's storage directly, an array
+// is shared between every value holding it so nothing is copied.
+static RuntimeResult* array_argument(Context* ctx, const char* native, const char* name, ArrayStorage& array)
+{
+	auto value = ctx->symbols->get(name)->second;
+
+	if (value.index() != Type::Native::ARRAY) {
+		return (new RuntimeResult())->failure(new RuntimeError(
+			nullptr,
+			nullptr,
+			std::string(native) + " expects an array",
+			ctx
+		));
+	}
+
+	array = std::get<ArrayStorage>(value);
+
+	return nullptr;
+}
+
+static RuntimeResult* index_argument(Context* ctx, const char* native, size_t limit, int& index)
+{
+	auto value = ctx->symbols->get("index")->second;
+
+	if (value.index() != Type::Native::INT || std::get<int>(value) < 0 || std::get<int>(value) >= (int)limit) {
+		return (new RuntimeResult())->failure(new RuntimeError(
+			nullptr,
+			nullptr,
+			std::string(native) + " index out of range",
+			ctx
+		));
+	}
+
+	index = std::get<int>(value);
+
+	return nullptr;
+}
+
+RuntimeResult* NativeFunction::fn_push(Context* ctx)
+{
+	ArrayStorage array;
+	auto error = array_argument(ctx, "push", "array", array);
+
+	if (error != nullptr)
+		return error;
+
+	array.push(Type::from(ctx->symbols->get("value")->second));
+
+	return (new RuntimeResult())->success(new Array(array));
+}
+
+RuntimeResult* NativeFunction::fn_pop(Context* ctx)
+{
+	ArrayStorage array;
+	auto error = array_argument(ctx, "pop", "array", array);
+
+	if (error != nullptr)
+		return error;
+
+	if (array.empty()) {
+		return (new RuntimeResult())->failure(new RuntimeError(
+			nullptr,
+			nullptr,
+			"pop from an empty array",
+			ctx
+		));
+	}
+
+	return (new RuntimeResult())->success(array.remove(array.size() - 1));
+}
+
+RuntimeResult* NativeFunction::fn_insert(Context* ctx)
+{
+	ArrayStorage array;
+	auto error = array_argument(ctx, "insert", "array", array);
+
+	if (error != nullptr)
+		return error;
+
+	int index = 0;
+	error = index_argument(ctx, "insert", array.size() + 1, index);
+
+	if (error != nullptr)
+		return error;
+
+	array.insert(index, Type::from(ctx->symbols->get("value")->second));
+
+	return (new RuntimeResult())->success(new Array(array));
+}
+
+RuntimeResult* NativeFunction::fn_remove(Context* ctx)
+{
+	ArrayStorage array;
+	auto error = array_argument(ctx, "remove", "array", array);
+
+	if (error != nullptr)
+		return error;
+
+	int index = 0;
+	error = index_argument(ctx, "remove", array.size(), index);
+
+	if (error != nullptr)
+		return error;
+
+	return (new RuntimeResult())->success(array.remove(index));
+}
+
+RuntimeResult* NativeFunction::fn_extend(Context* ctx)
+{
+	ArrayStorage array;
+	ArrayStorage other;
+	auto error = array_argument(ctx, "extend", "array", array);
+
+	if (error == nullptr)
+		error = array_argument(ctx, "extend", "other", other);
+
+	if (error != nullptr)
+		return error;
+
+	array.extend(other);
+
+	return (new RuntimeResult())->success(new Array(array));
+}
+
+// Numbers of an array in packed form. Packed storage is read in place, a
+// boxed array of numbers is converted once into the local buffers.
+struct NumericView {
+	ArrayStorage::Kind kind = ArrayStorage::Kind::BOXED;
+	size_t size = 0;
+	const int* ints = nullptr;
+	const double* doubles = nullptr;
+	std::vector<int> int_buffer;
+	std::vector<double> double_buffer;
+
+	const double* as_doubles()
+	{
+		if (doubles == nullptr) {
+			double_buffer.assign(ints, ints + size);
+			doubles = double_buffer.data();
 		}
-		catch (const std::bad_variant_access&) {}
+
+		return doubles;
 	}
-	break;
-	case Type::Native::MAP: {
-		try {
-			auto map = std::get<std::map<std::string, Type*>>(value);
-			auto map_it = map.begin();
+};
 
-			for (; map_it != map.end(); ++map_it)
-				values.push_back(map_it->second);
+static RuntimeResult* numeric_argument(Context* ctx, const char* native, const char* name, NumericView& view)
+{
+	ArrayStorage array;
+	auto error = array_argument(ctx, native, name, array);
+
+	if (error != nullptr)
+		return error;
+
+	view.size = array.size();
+	view.kind = array.kind();
+
+	switch (array.kind()) {
+	case ArrayStorage::Kind::INTS:
+		view.ints = array.ints().data();
+		return nullptr;
+	case ArrayStorage::Kind::DOUBLES:
+		view.doubles = array.doubles().data();
+		return nullptr;
+	default:
+		break;
+	}
+
+	view.kind = ArrayStorage::Kind::INTS;
+
+	for (auto element : array.boxed()) {
+		auto index = element != nullptr ? element->value.index() : (size_t)Type::Native::OBJECT;
+
+		if (index == Type::Native::DOUBLE)
+			view.kind = ArrayStorage::Kind::DOUBLES;
+		else if (index != Type::Native::INT) {
+			return (new RuntimeResult())->failure(new RuntimeError(
+				nullptr,
+				nullptr,
+				std::string(native) + " expects an array of numbers",
+				ctx
+			));
 		}
-		catch (const std::bad_variant_access&) {}
 	}
-	break;
+
+	for (auto element : array.boxed()) {
+		if (view.kind == ArrayStorage::Kind::INTS)
+			view.int_buffer.push_back(std::get<int>(element->value));
+		else if (element->is(Type::Native::INT))
+			view.double_buffer.push_back(std::get<int>(element->value));
+		else
+			view.double_buffer.push_back(std::get<double>(element->value));
 	}
 
-	result_value->value = values;
+	view.ints = view.int_buffer.data();
+	view.doubles = view.kind == ArrayStorage::Kind::DOUBLES ? view.double_buffer.data() : nullptr;
 
-	return result->success(result_value);
+	return nullptr;
+}
+
+static RuntimeResult* empty_argument(Context* ctx, const char* native)
+{
+	return (new RuntimeResult())->failure(new RuntimeError(
+		nullptr,
+		nullptr,
+		std::string(native) + " of an empty array",
+		ctx
+	));
+}
+
+// Integer results stay integers unless they no longer fit one.
+static Number* integer_result(long long value)
+{
+	if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max())
+		return new Number((double)value);
+
+	return new Number((int)value);
+}
+
+RuntimeResult* NativeFunction::fn_sum(Context* ctx)
+{
+	NumericView view;
+	auto error = numeric_argument(ctx, "sum", "array", view);
+
+	if (error != nullptr)
+		return error;
+
+	if (view.kind == ArrayStorage::Kind::INTS)
+		return (new RuntimeResult())->success(integer_result(Kernels::sum(view.ints, view.size)));
+
+	return (new RuntimeResult())->success(new Number(Kernels::sum(view.doubles, view.size)));
+}
+
+RuntimeResult* NativeFunction::fn_mean(Context* ctx)
+{
+	NumericView view;
+	auto error = numeric_argument(ctx, "mean", "array", view);
+
+	if (error != nullptr)
+		return error;
+
+	if (view.size == 0)
+		return empty_argument(ctx, "mean");
+
+	double total = view.kind == ArrayStorage::Kind::INTS
+		? (double)Kernels::sum(view.ints, view.size)
+		: Kernels::sum(view.doubles, view.size);
+
+	return (new RuntimeResult())->success(new Number(total / view.size));
+}
+
+RuntimeResult* NativeFunction::fn_dot(Context* ctx)
+{
+	NumericView a;
+	NumericView b;
+	auto error = numeric_argument(ctx, "dot", "a", a);
+
+	if (error == nullptr)
+		error = numeric_argument(ctx, "dot", "b", b);
+
+	if (error != nullptr)
+		return error;
+
+	if (a.size != b.size) {
+		return (new RuntimeResult())->failure(new RuntimeError(
+			nullptr,
+			nullptr,
+			"dot expects arrays of the same size",
+			ctx
+		));
+	}
+
+	if (a.kind == ArrayStorage::Kind::INTS && b.kind == ArrayStorage::Kind::INTS)
+		return (new RuntimeResult())->success(integer_result(Kernels::dot(a.ints, b.ints, a.size)));
+
+	return (new RuntimeResult())->success(new Number(Kernels::dot(a.as_doubles(), b.as_doubles(), a.size)));
+}
+
+// Shared body of vadd, vsub, vmul and vdiv: `b` is either an array of the
+// same size or a single number applied to every element.
+static RuntimeResult* elementwise(Context* ctx, const char* native, Kernels::Operation operation)
+{
+	NumericView a;
+	NumericView b;
+	auto error = numeric_argument(ctx, native, "a", a);
+
+	if (error != nullptr)
+		return error;
+
+	auto other = ctx->symbols->get("b")->second;
+	double scalar = 0.0;
+
+	if (other.index() == Type::Native::ARRAY) {
+		error = numeric_argument(ctx, native, "b", b);
+
+		if (error != nullptr)
+			return error;
+
+		if (a.size != b.size) {
+			return (new RuntimeResult())->failure(new RuntimeError(
+				nullptr,
+				nullptr,
+				std::string(native) + " expects arrays of the same size",
+				ctx
+			));
+		}
+	}
+	else if (other.index() == Type::Native::INT) {
+		b.kind = ArrayStorage::Kind::INTS;
+		scalar = std::get<int>(other);
+	}
+	else if (other.index() == Type::Native::DOUBLE) {
+		b.kind = ArrayStorage::Kind::DOUBLES;
+		scalar = std::get<double>(other);
+	}
+	else {
+		return (new RuntimeResult())->failure(new RuntimeError(
+			nullptr,
+			nullptr,
+			std::string(native) + " expects an array or a number",
+			ctx
+		));
+	}
+
+	bool array = other.index() == Type::Native::ARRAY;
+
+	if (operation != Kernels::DIVIDE
+		&& a.kind == ArrayStorage::Kind::INTS
+		&& b.kind == ArrayStorage::Kind::INTS) {
+		std::vector<int> out(a.size);
+
+		// Results that overflow an int are computed again as doubles.
+		if (Kernels::apply(operation, a.ints, array ? b.ints : nullptr, (int)scalar, out.data(), a.size))
+			return (new RuntimeResult())->success(new Array(ArrayStorage(std::move(out))));
+	}
+
+	std::vector<double> out(a.size);
+	Kernels::apply(operation, a.as_doubles(), array ? b.as_doubles() : nullptr, scalar, out.data(), a.size);
+
+	return (new RuntimeResult())->success(new Array(ArrayStorage(std::move(out))));
+}
+
+RuntimeResult* NativeFunction::fn_vadd(Context* ctx)
+{
+	return elementwise(ctx, "vadd", Kernels::ADD);
+}
+
+RuntimeResult* NativeFunction::fn_vsub(Context* ctx)
+{
+	return elementwise(ctx, "vsub", Kernels::SUBTRACT);
+}
+
+RuntimeResult* NativeFunction::fn_vmul(Context* ctx)
+{
+	return elementwise(ctx, "vmul", Kernels::MULTIPLY);
+}
+
+RuntimeResult* NativeFunction::fn_vdiv(Context* ctx)
+{
+	return elementwise(ctx, "vdiv", Kernels::DIVIDE);
 }
 
 RuntimeResult* NativeFunction::fn_sizeof(Context* ctx)
@@ -333,15 +894,19 @@ RuntimeResult* NativeFunction::fn_sizeof(Context* ctx)
 
 	switch (value.index()) {
 	case Type::Native::STRING:
-		try { size->value = (int)std::get<std::string>(value).size(); }
+		try { size->value = (int)std::get<SharedString>(value).size(); }
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::ARRAY:
-		try { size->value = (int)std::get<std::vector<Type*>>(value).size(); }
+		try { size->value = (int)std::get<ArrayStorage>(value).size(); }
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::MAP:
-		try { size->value = (int)std::get<std::map<std::string, Type*>>(value).size(); }
+		try { size->value = (int)std::get<MapStorage>(value).size(); }
+		catch (const std::bad_variant_access&) {}
+		break;
+	case Type::Native::RANGE:
+		try { size->value = (int)std::get<Range>(value).size(); }
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::FILE:
@@ -361,11 +926,11 @@ RuntimeResult* NativeFunction::fn_hsize(Context* ctx)
 
 	switch (value.index()) {
 	case Type::Native::STRING:
-		try { size->value = Utils::bytesToSize((int)std::get<std::string>(value).length()); }
+		try { size->value = Utils::bytesToSize((int)std::get<SharedString>(value).length()); }
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::ARRAY:
-		try { size->value = Utils::bytesToSize(sizeof std::get<std::vector<Type*>>(value).size()); }
+		try { size->value = Utils::bytesToSize(sizeof std::get<ArrayStorage>(value).size()); }
 		catch (const std::bad_variant_access&) {}
 		break;
 	case Type::Native::FILE:
@@ -384,14 +949,17 @@ RuntimeResult* NativeFunction::fn_typeof(Context* ctx)
 	auto string = new String();
 
 	switch (value.index()) {
-	case Type::Native::DOUBLE   : string->value = std::string("float"); break;
-	case Type::Native::INT	    : string->value = std::string("integer"); break;
-	case Type::Native::BOOL     : string->value = std::string("boolean"); break;
-	case Type::Native::FUNCTION : string->value = std::string("function"); break;
-	case Type::Native::STRING   : string->value = std::string("string"); break;
-	case Type::Native::ARRAY    : string->value = std::string("array"); break;
-	case Type::Native::FILE		: string->value = std::string("file"); break;
-	case Type::Native::MAP		: string->value = std::string("map"); break;
+	case Type::Native::DOUBLE   : string->value = SharedString("float"); break;
+	case Type::Native::INT	    : string->value = SharedString("integer"); break;
+	case Type::Native::BOOL     : string->value = SharedString("boolean"); break;
+	case Type::Native::FUNCTION : string->value = SharedString("function"); break;
+	case Type::Native::STRING   : string->value = SharedString("string"); break;
+	case Type::Native::ARRAY    : string->value = SharedString("array"); break;
+	case Type::Native::FILE		: string->value = SharedString("file"); break;
+	case Type::Native::MAP		: string->value = SharedString("map"); break;
+	case Type::Native::RANGE	:
+		string->value = SharedString(std::get<Range>(value).kind() == Range::Kind::STREAM ? "generator" : "range");
+		break;
 	}
 
 	return result->success(string);
@@ -408,10 +976,10 @@ RuntimeResult* NativeFunction::fn_chr(Context* ctx)
 		index.index() == Type::Native::INT) {
 
 		auto id = std::get<int>(index);
-		auto str = std::get<std::string>(string);
+		auto& str = std::get<SharedString>(string);
 
 		if (id >= 0 && id < str.size()) {
-			try { character->value = std::string(1, str.at(id)); }
+			try { character->value = SharedString(std::string_view(str.data() + id, 1)); }
 			catch (const std::bad_variant_access&) {}
 		}
 	}
@@ -426,7 +994,7 @@ RuntimeResult* NativeFunction::fn_exec(Context* ctx)
 	auto return_value = new Number();
 
 	if (command.index() == Type::Native::STRING) {
-		return_value->value = system(std::get<std::string>(command).c_str());
+		return_value->value = system(std::get<SharedString>(command).c_str());
 	}
 
 	return result->success(return_value);
@@ -439,17 +1007,17 @@ RuntimeResult* NativeFunction::fn_open(Context* ctx)
 	auto arg_mode = ctx->symbols->get("mode")->second;
 	std::string arg_mode_str;
 
-	try { arg_mode_str = std::get<std::string>(arg_mode); }
+	try { arg_mode_str = std::get<SharedString>(arg_mode); }
 	catch (const std::bad_variant_access&) {}
 
 	if (arg_mode_str.find("?") != std::string::npos)
-		arg_mode = "r";
+		arg_mode = SharedString("r");
 
 	int read_mode = 0;
 	auto out = new Type();
 
 	std::string mode_value;
-	try { mode_value = std::get<std::string>(arg_mode); }
+	try { mode_value = std::get<SharedString>(arg_mode); }
 	catch (const std::bad_variant_access&) {}
 
 	if (mode_value == "r")
@@ -468,7 +1036,7 @@ RuntimeResult* NativeFunction::fn_open(Context* ctx)
 		read_mode = std::ifstream::trunc;
 
 	std::string filename_value;
-	try { filename_value = std::get<std::string>(arg_filename); }
+	try { filename_value = std::get<SharedString>(arg_filename); }
 	catch (const std::bad_variant_access&) {}
 
 	std::ifstream stream;
@@ -487,15 +1055,13 @@ RuntimeResult* NativeFunction::fn_open(Context* ctx)
 	std::streampos length = stream.tellg();
 	stream.seekg(0, std::ios::beg);
 
-	std::vector<char> buffer(length);
-	stream.read(&buffer[0], length);
-
-	std::string str(&buffer[0]);
+	std::string str((size_t)length, '\0');
+	stream.read(&str[0], length);
 	auto file = new File();
 
 	file->closed = false;
 	file->name = filename_value;
-	file->value = str.substr(0, str.size());
+	file->value = str;
 	file->mode = static_cast<File::Mode>(read_mode);
 	file->size = std::filesystem::file_size(filename_value);
 
@@ -618,9 +1184,9 @@ RuntimeResult* NativeFunction::fn_wget(Context* ctx)
 	RuntimeResult* result = new RuntimeResult();
 	auto value = ctx->symbols->get("value")->second;
 	auto map = new Map();
-	std::map<std::string, Type*> elements = {};
+	MapStorage elements;
 
-	auto url = std::get<std::string>(value);
+	auto url = std::get<SharedString>(value);
 	auto c_str = url.c_str();
 	std::wstring wstr(c_str, c_str + strlen(c_str));
 
@@ -631,17 +1197,21 @@ RuntimeResult* NativeFunction::fn_wget(Context* ctx)
 	auto path = std::string(parsed.Path.begin(), parsed.Path.end());
 	auto qs = std::string(parsed.QueryString.begin(), parsed.QueryString.end());
 
+	auto start = std::chrono::steady_clock::now();
 	std::string response = Http::get(parsed);
+
+	static auto& latency = Metrics::histogram("bird_wget_duration_seconds", "Latency of wget requests.");
+	latency.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
 	auto parts = Utils::splitString(response, "\r\n\r\n");
 
-	elements["host"] = new String(host);
-	elements["port"] = new Number(port.size() == 0 ? 80 : std::stoi(port));
-	elements["protocol"] = new String(protocol);
-	elements["path"] = new String(path.size() == 0 ? "/" : path);
-	elements["query"] = new String(qs);
+	elements.set("host", new String(host));
+	elements.set("port", new Number(port.size() == 0 ? 80 : std::stoi(port)));
+	elements.set("protocol", new String(protocol));
+	elements.set("path", new String(path.size() == 0 ? "/" : path));
+	elements.set("query", new String(qs));
 
 	auto headers_entries = new Map();
-	std::map<std::string, Type*> entries = {};
+	MapStorage entries;
 
 	auto headers_lines = Utils::splitString(parts.at(0), "\n");
 	unsigned int i = 0;
@@ -649,7 +1219,7 @@ RuntimeResult* NativeFunction::fn_wget(Context* ctx)
 	for (auto line : headers_lines) {
 		if (i >= 1) {
 			auto line_parts = Utils::splitString(line, ": ");
-			entries[line_parts[0]] = new String(Utils::rtrim(Utils::ltrim(line_parts[1])));
+			entries.set(line_parts[0], new String(Utils::rtrim(Utils::ltrim(line_parts[1]))));
 		}
 
 		i++;
@@ -657,8 +1227,8 @@ RuntimeResult* NativeFunction::fn_wget(Context* ctx)
 
 	headers_entries->value = entries;
 
-	elements["headers"] = headers_entries;
-	elements["body"] = new String(parts.at(1));
+	elements.set("headers", headers_entries);
+	elements.set("body", new String(parts.at(1)));
 
 	map->value = elements;
 
@@ -972,6 +1542,25 @@ RuntimeResult* NativeFunction::fn_max(Context* ctx)
 	auto y = ctx->symbols->get("y")->second;
 	auto max = new Number();
 
+	// A single array argument reduces the whole array.
+	if (x.index() == Type::Native::ARRAY) {
+		NumericView view;
+		auto error = numeric_argument(ctx, "max", "x", view);
+
+		if (error != nullptr)
+			return error;
+
+		if (view.size == 0)
+			return empty_argument(ctx, "max");
+
+		if (view.kind == ArrayStorage::Kind::INTS)
+			max->value = Kernels::max(view.ints, view.size);
+		else
+			max->value = Kernels::max(view.doubles, view.size);
+
+		return result->success(max);
+	}
+
 	if (x.index() == Type::Native::INT && y.index() == Type::Native::INT) {
 		try { max->value = std::max(std::get<int>(x), std::get<int>(y)); }
 		catch (const std::bad_variant_access&) {}
@@ -987,6 +1576,25 @@ RuntimeResult* NativeFunction::fn_min(Context* ctx)
 	auto y = ctx->symbols->get("y")->second;
 	auto min = new Number();
 
+	// A single array argument reduces the whole array.
+	if (x.index() == Type::Native::ARRAY) {
+		NumericView view;
+		auto error = numeric_argument(ctx, "min", "x", view);
+
+		if (error != nullptr)
+			return error;
+
+		if (view.size == 0)
+			return empty_argument(ctx, "min");
+
+		if (view.kind == ArrayStorage::Kind::INTS)
+			min->value = Kernels::min(view.ints, view.size);
+		else
+			min->value = Kernels::min(view.doubles, view.size);
+
+		return result->success(min);
+	}
+
 	if (x.index() == Type::Native::INT && y.index() == Type::Native::INT) {
 		try { min->value = std::min(std::get<int>(x), std::get<int>(y)); }
 		catch (const std::bad_variant_access&) {}
@@ -1,6 +1,24 @@
 #include "pch.h"
 #include "Nodes.h"
 
+void Node::discard(Node* node)
+{
+	if (node == nullptr)
+		return;
+
+	node->discarded = true;
+
+	// The value of a branch is the value of the if, nothing reads it either.
+	if (node->type == Type::IF_STATEMENT) {
+		auto if_node = (IfStatementNode*)node;
+
+		for (auto& if_case : if_node->cases)
+			discard(if_case.second);
+
+		discard(if_node->else_case);
+	}
+}
+
 std::ostream& operator << (std::ostream& stream, Node* node)
 {
 	return stream << node->typeToStr() << ':' << node->token;
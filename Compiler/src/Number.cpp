@@ -5,6 +5,7 @@
 Number::Number(const DynamicType& value) :
 	Type(value)
 {
+	Allocations::refine(Allocations::Kind::NUMBER, sizeof(Number));
 }
 
 std::pair<Type*, Error*> Number::add(Type* other)
@@ -30,12 +31,12 @@ std::pair<Type*, Error*> Number::add(Type* other)
 	}
 	else if (this->is(Type::Native::DOUBLE) && other->is(Type::Native::STRING)) {
 		result = new String();
-		try { ((String*)result)->value = std::to_string(std::get<double>(value)) + std::get<std::string>(other->value); }
+		try { ((String*)result)->value = SharedString::concat(std::to_string(std::get<double>(value)), std::get<SharedString>(other->value)); }
 		catch (const std::bad_variant_access&) {}
 	}
 	else if (this->is(Type::Native::INT) && other->is(Type::Native::STRING)) {
 		result = new String();
-		try { result->value = std::to_string(std::get<int>(value)) + std::get<std::string>(other->value); }
+		try { result->value = SharedString::concat(std::to_string(std::get<int>(value)), std::get<SharedString>(other->value)); }
 		catch (const std::bad_variant_access&) {}
 	}
 
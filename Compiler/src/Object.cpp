@@ -4,6 +4,7 @@
 Object::Object(const DynamicType& value) :
 	Type(value)
 {
+	Allocations::refine(Allocations::Kind::OBJECT, sizeof(Object));
 }
 
 std::pair<Type*, Error*> Object::compare_less_than(Type* other)
@@ -0,0 +1,937 @@
+#include "pch.h"
+#include "Optimizer.h"
+#include "NativeFunction.h"
+
+static std::string parameter_name(Token* token)
+{
+	return std::get<std::string>(token->value);
+}
+
+static Token* copy(Token* token)
+{
+	return token != nullptr ? new Token(token) : nullptr;
+}
+
+// Names a function body binds in its own scope. Nested definitions bind
+// their name here, the rest of what they bind is theirs.
+static void local_names(Node* node, std::set<std::string>& names)
+{
+	if (node == nullptr)
+		return;
+
+	switch (node->type) {
+	case Node::Type::VARIABLE_ASSIGN:
+	case Node::Type::FOR_STATEMENT:
+		names.insert(std::get<std::string>(node->token->value));
+		break;
+	case Node::Type::FN_DEFINITION:
+		if (node->token != nullptr)
+			names.insert(std::get<std::string>(node->token->value));
+
+		return;
+	default:
+		break;
+	}
+
+	for (auto slot : Optimizer::children(node))
+		local_names(*slot, names);
+}
+
+// Natives without side effects, and whether they read the contents of
+// the arrays they are given.
+static const std::map<std::string, bool> pure_natives = {
+	{ "sizeof", true }, { "sum", true }, { "mean", true }, { "dot", true },
+	{ "int", false }, { "float", false }, { "bool", false },
+	{ "abs", false }, { "acos", false }, { "acosh", false }, { "asin", false },
+	{ "asinh", false }, { "atan", false }, { "atan2", false }, { "atanh", false },
+	{ "cbrt", false }, { "ceil", false }, { "cos", false }, { "cosh", false },
+	{ "exp", false }, { "floor", false }, { "log", false }, { "max", false },
+	{ "min", false }, { "pow", false }, { "round", false }, { "sin", false },
+	{ "sinh", false }, { "sqrt", false }, { "tan", false }, { "tanh", false },
+	{ "trunc", false }
+};
+
+static void referenced(Node* node, std::set<std::string>& names)
+{
+	if (node == nullptr)
+		return;
+
+	switch (node->type) {
+	case Node::Type::VARIABLE_ACCESS:
+	case Node::Type::VARIABLE_ASSIGN:
+	case Node::Type::FOR_STATEMENT:
+	case Node::Type::INDEX_ACCESS:
+	case Node::Type::INDEX_ASSIGN:
+		names.insert(std::get<std::string>(node->token->value));
+		break;
+	case Node::Type::PROPERTY_ACCESS:
+		names.insert(((PropertyAccessNode*)node)->var_name);
+		break;
+	case Node::Type::FN_DEFINITION:
+		if (node->token != nullptr)
+			names.insert(std::get<std::string>(node->token->value));
+
+		for (auto arg : ((FunctionDefinitionNode*)node)->args_names)
+			names.insert(BaseFunction::optional_name(parameter_name(arg)));
+
+		break;
+	default:
+		break;
+	}
+
+	for (auto slot : Optimizer::children(node))
+		referenced(*slot, names);
+}
+
+bool Optimizer::optimize(std::vector<Node*>& program)
+{
+	using milliseconds = std::chrono::duration<double, std::milli>;
+
+	statistics.clear();
+	error.clear();
+
+	auto pass = [&](const std::string& name, const std::function<unsigned int()>& run) {
+		auto started = std::chrono::steady_clock::now();
+		auto changes = run();
+		auto valid = verify(program);
+
+		statistics.push_back({ name, changes, milliseconds(std::chrono::steady_clock::now() - started).count() });
+
+		if (!valid)
+			error = name + ": " + error;
+
+		return valid;
+	};
+
+	return pass("inline", [&]() { return inline_program(program); })
+		&& pass("hoist", [&]() {
+			unsigned int count = 0;
+
+			for (auto& node : program)
+				count += hoist(node);
+
+			return count;
+		})
+		&& pass("reduce", [&]() {
+			unsigned int count = 0;
+
+			for (auto& node : program)
+				count += reduce(node);
+
+			return count;
+		});
+}
+
+unsigned int Optimizer::changes(const std::string& pass) const
+{
+	for (auto& stat : statistics) {
+		if (stat.name == pass)
+			return stat.changes;
+	}
+
+	return 0;
+}
+
+unsigned int Optimizer::inline_program(std::vector<Node*>& program)
+{
+	candidates.clear();
+	bound.clear();
+	names.clear();
+
+	for (auto node : program) {
+		bindings(node, bound);
+		referenced(node, names);
+	}
+
+	for (size_t i = 0; i < program.size(); i++) {
+		if (program[i]->type != Node::Type::FN_DEFINITION || program[i]->token == nullptr)
+			continue;
+
+		auto fn_node = (FunctionDefinitionNode*)program[i];
+		auto name = std::get<std::string>(fn_node->token->value);
+
+		if (fn_node->generator || bound[name] != 1)
+			continue;
+
+		Candidate candidate = { fn_node, i, {} };
+		bool optional = false;
+
+		for (auto arg : fn_node->args_names) {
+			candidate.parameters.push_back(parameter_name(arg));
+			optional |= candidate.parameters.back().find('?') != std::string::npos;
+		}
+
+		if (!optional)
+			candidates[name] = candidate;
+	}
+
+	unsigned int count = 0;
+
+	for (size_t i = 0; i < program.size(); i++)
+		count += inline_calls(program[i], i);
+
+	return count;
+}
+
+std::vector<Node**> Optimizer::children(Node* node)
+{
+	std::vector<Node**> slots;
+
+	if (node == nullptr)
+		return slots;
+
+	switch (node->type) {
+	case Node::Type::UNARY:
+		slots.push_back(&((UnaryOperationNode*)node)->node);
+		break;
+	case Node::Type::IF_STATEMENT: {
+		auto if_node = (IfStatementNode*)node;
+
+		for (auto& if_case : if_node->cases) {
+			slots.push_back(&if_case.first);
+			slots.push_back(&if_case.second);
+		}
+
+		slots.push_back(&if_node->else_case);
+		break;
+	}
+	case Node::Type::FOR_STATEMENT: {
+		auto for_node = (ForStatementNode*)node;
+		slots.insert(slots.end(), { &for_node->start_value, &for_node->end_value, &for_node->step, &for_node->body });
+		break;
+	}
+	case Node::Type::WHILE_STATEMENT: {
+		auto while_node = (WhileStatementNode*)node;
+		slots.insert(slots.end(), { &while_node->condition, &while_node->body });
+		break;
+	}
+	case Node::Type::FN_DEFINITION:
+		slots.push_back(&((FunctionDefinitionNode*)node)->body);
+		break;
+	case Node::Type::FN_CALL: {
+		auto call_node = (FunctionCallNode*)node;
+		slots.push_back(&call_node->callee);
+
+		for (auto& arg : call_node->args_nodes)
+			slots.push_back(&arg);
+
+		break;
+	}
+	case Node::Type::ARRAY:
+		for (auto& element : ((ArrayNode*)node)->elements)
+			slots.push_back(&element);
+
+		break;
+	case Node::Type::MAP:
+		for (auto& element : ((MapNode*)node)->elements)
+			slots.push_back(&element.second);
+
+		break;
+	default:
+		slots.insert(slots.end(), { &node->left, &node->right });
+		break;
+	}
+
+	slots.erase(std::remove_if(slots.begin(), slots.end(), [](Node** slot) { return *slot == nullptr; }), slots.end());
+
+	return slots;
+}
+
+unsigned int Optimizer::size(Node* node)
+{
+	unsigned int count = 1;
+
+	for (auto slot : children(node))
+		count += size(*slot);
+
+	return count;
+}
+
+void Optimizer::bindings(Node* node, std::map<std::string, unsigned int>& counts)
+{
+	if (node == nullptr)
+		return;
+
+	switch (node->type) {
+	case Node::Type::VARIABLE_ASSIGN:
+	case Node::Type::FOR_STATEMENT:
+		counts[std::get<std::string>(node->token->value)]++;
+		break;
+	case Node::Type::FN_DEFINITION: {
+		auto fn_node = (FunctionDefinitionNode*)node;
+
+		if (fn_node->token != nullptr)
+			counts[std::get<std::string>(fn_node->token->value)]++;
+
+		for (auto arg : fn_node->args_names)
+			counts[BaseFunction::optional_name(parameter_name(arg))]++;
+
+		break;
+	}
+	default:
+		break;
+	}
+
+	for (auto slot : children(node))
+		bindings(*slot, counts);
+}
+
+unsigned int Optimizer::inline_calls(Node*& node, size_t statement)
+{
+	if (node == nullptr)
+		return 0;
+
+	if (node->type == Node::Type::FN_DEFINITION) {
+		auto fn_node = (FunctionDefinitionNode*)node;
+		std::set<std::string> scope;
+
+		for (auto arg : fn_node->args_names)
+			scope.insert(BaseFunction::optional_name(parameter_name(arg)));
+
+		local_names(fn_node->body, scope);
+
+		locals.push_back(scope);
+		auto count = inline_calls(fn_node->body, statement);
+		locals.pop_back();
+
+		return count;
+	}
+
+	unsigned int count = 0;
+
+	for (auto slot : children(node))
+		count += inline_calls(*slot, statement);
+
+	if (node->type == Node::Type::UNARY)
+		node->right = ((UnaryOperationNode*)node)->node;
+
+	if (node->type != Node::Type::FN_CALL)
+		return count;
+
+	auto call = (FunctionCallNode*)node;
+
+	if (call->callee->type != Node::Type::VARIABLE_ACCESS)
+		return count;
+
+	auto candidate = candidates.find(std::get<std::string>(call->callee->token->value));
+
+	// The function must already be defined when the call runs.
+	if (candidate == candidates.end() || candidate->second.statement >= statement)
+		return count;
+
+	auto expanded = expand(call, candidate->second);
+
+	if (expanded == nullptr)
+		return count;
+
+	if (call->discarded)
+		Node::discard(expanded);
+
+	for (auto arg : call->args_nodes)
+		delete arg;
+
+	delete call;
+
+	node = expanded;
+
+	return count + 1;
+}
+
+Node* Optimizer::expand(FunctionCallNode* call, const Candidate& candidate)
+{
+	auto body = candidate.definition->body;
+
+	if (call->args_nodes.size() != candidate.parameters.size() || size(body) > INLINE_BUDGET)
+		return nullptr;
+
+	std::map<std::string, Node*> arguments;
+
+	for (size_t i = 0; i < candidate.parameters.size(); i++) {
+		auto arg = call->args_nodes[i];
+
+		// Substituted arguments are evaluated once per use, or not at all.
+		if (arg->type != Node::Type::NUMERIC && arg->type != Node::Type::STRING && arg->type != Node::Type::VARIABLE_ACCESS)
+			return nullptr;
+
+		arguments[candidate.parameters[i]] = arg;
+	}
+
+	std::set<std::string> used;
+
+	if (!inlinable(body, std::get<std::string>(candidate.definition->token->value), arguments, used))
+		return nullptr;
+
+	// An unused name argument would no longer fail when it is not defined.
+	for (auto& argument : arguments) {
+		if (argument.second->type == Node::Type::VARIABLE_ACCESS && used.count(argument.first) == 0)
+			return nullptr;
+	}
+
+	return clone(body, arguments);
+}
+
+bool Optimizer::inlinable(
+	Node* node,
+	const std::string& name,
+	const std::map<std::string, Node*>& arguments,
+	std::set<std::string>& used
+)
+{
+	// Free names of the body are globals, a local of an enclosing function
+	// would shadow them at the call site.
+	auto global = [this](const std::string& free) {
+		for (auto& names : locals) {
+			if (names.count(free) != 0)
+				return false;
+		}
+
+		return true;
+	};
+
+	// Renames a container parameter, only possible with a name argument.
+	auto container = [&](const std::string& container_name) {
+		auto argument = arguments.find(container_name);
+
+		if (argument == arguments.end())
+			return global(container_name);
+
+		used.insert(container_name);
+		return argument->second->type == Node::Type::VARIABLE_ACCESS;
+	};
+
+	switch (node->type) {
+	case Node::Type::NUMERIC:
+	case Node::Type::STRING:
+		return true;
+	case Node::Type::VARIABLE_ACCESS: {
+		auto& variable = std::get<std::string>(node->token->value);
+
+		if (arguments.count(variable) != 0) {
+			used.insert(variable);
+			return true;
+		}
+
+		return global(variable);
+	}
+	case Node::Type::INDEX_ACCESS:
+		if (!container(std::get<std::string>(node->token->value)))
+			return false;
+
+		break;
+	case Node::Type::PROPERTY_ACCESS:
+		return container(((PropertyAccessNode*)node)->var_name);
+	case Node::Type::FN_CALL: {
+		auto callee = ((FunctionCallNode*)node)->callee;
+
+		if (callee->type != Node::Type::VARIABLE_ACCESS)
+			return false;
+
+		auto& callee_name = std::get<std::string>(callee->token->value);
+
+		if (callee_name == name || arguments.count(callee_name) != 0 || !global(callee_name))
+			return false;
+
+		// Natives bind their arguments in the scope they are called from,
+		// which becomes the caller's. None of those names may be in use.
+		auto native = bound.count(callee_name) == 0 ? NativeFunction::find(callee_name) : nullptr;
+
+		if (native != nullptr) {
+			for (auto arg : native->args_names) {
+				if (arg != nullptr && bound.count(BaseFunction::optional_name(arg)) != 0)
+					return false;
+			}
+		}
+
+		for (auto arg : ((FunctionCallNode*)node)->args_nodes) {
+			if (!inlinable(arg, name, arguments, used))
+				return false;
+		}
+
+		return true;
+	}
+	case Node::Type::BINARY:
+	case Node::Type::UNARY:
+	case Node::Type::IF_STATEMENT:
+	case Node::Type::ARRAY:
+	case Node::Type::MAP:
+		break;
+	default:
+		return false;
+	}
+
+	for (auto slot : children(node)) {
+		if (!inlinable(*slot, name, arguments, used))
+			return false;
+	}
+
+	return true;
+}
+
+Node* Optimizer::clone(Node* node, const std::map<std::string, Node*>& arguments)
+{
+	if (node == nullptr)
+		return nullptr;
+
+	auto renamed = [&](const std::string& variable) {
+		auto argument = arguments.find(variable);
+		return argument != arguments.end() ? std::get<std::string>(argument->second->token->value) : variable;
+	};
+
+	switch (node->type) {
+	case Node::Type::NUMERIC:
+		return new NumericNode(copy(node->token));
+	case Node::Type::STRING:
+		return new StringNode(copy(node->token));
+	case Node::Type::VARIABLE_ACCESS: {
+		auto argument = arguments.find(std::get<std::string>(node->token->value));
+
+		if (argument != arguments.end())
+			return clone(argument->second, {});
+
+		return new VariableAccessNode(copy(node->token));
+	}
+	case Node::Type::BINARY:
+		return new BinaryOperationNode(clone(node->left, arguments), copy(node->token), clone(node->right, arguments));
+	case Node::Type::UNARY:
+		return new UnaryOperationNode(clone(((UnaryOperationNode*)node)->node, arguments), copy(node->token));
+	case Node::Type::IF_STATEMENT: {
+		auto if_node = (IfStatementNode*)node;
+		std::vector<std::pair<Node*, Node*>> cases;
+
+		for (auto& if_case : if_node->cases)
+			cases.push_back({ clone(if_case.first, arguments), clone(if_case.second, arguments) });
+
+		return new IfStatementNode(copy(if_node->token), cases, clone(if_node->else_case, arguments));
+	}
+	case Node::Type::FN_CALL: {
+		auto call_node = (FunctionCallNode*)node;
+		std::vector<Node*> args;
+
+		for (auto arg : call_node->args_nodes)
+			args.push_back(clone(arg, arguments));
+
+		return new FunctionCallNode(copy(call_node->token), clone(call_node->callee, arguments), args);
+	}
+	case Node::Type::ARRAY: {
+		std::vector<Node*> elements;
+
+		for (auto element : ((ArrayNode*)node)->elements)
+			elements.push_back(clone(element, arguments));
+
+		return new ArrayNode(copy(node->token), elements);
+	}
+	case Node::Type::MAP: {
+		std::vector<std::pair<std::string, Node*>> elements;
+
+		for (auto& element : ((MapNode*)node)->elements)
+			elements.push_back({ element.first, clone(element.second, arguments) });
+
+		return new MapNode(copy(node->token), elements);
+	}
+	case Node::Type::INDEX_ACCESS: {
+		auto token = copy(node->token);
+		token->value = renamed(std::get<std::string>(token->value));
+
+		return new IndexAccessNode(token, clone(node->left, arguments), nullptr, nullptr);
+	}
+	case Node::Type::PROPERTY_ACCESS: {
+		auto property_node = (PropertyAccessNode*)node;
+		std::vector<Token*> path;
+
+		for (auto part : property_node->path)
+			path.push_back(copy(part));
+
+		return new PropertyAccessNode(copy(property_node->token), renamed(property_node->var_name), path);
+	}
+	default:
+		return nullptr;
+	}
+}
+
+bool Optimizer::pure(Node* call, bool& reads)
+{
+	auto callee = ((FunctionCallNode*)call)->callee;
+
+	if (callee->type != Node::Type::VARIABLE_ACCESS)
+		return false;
+
+	auto& name = std::get<std::string>(callee->token->value);
+	auto entry = pure_natives.find(name);
+	auto native = bound.count(name) == 0 ? NativeFunction::find(name) : nullptr;
+
+	if (entry == pure_natives.end() || native == nullptr)
+		return false;
+
+	// The arguments are bound in the caller's scope, a call left out must
+	// not be observable through them.
+	for (auto arg : native->args_names) {
+		if (arg != nullptr && names.count(BaseFunction::optional_name(arg)) != 0)
+			return false;
+	}
+
+	reads = entry->second;
+	return true;
+}
+
+bool Optimizer::analyze(Node* node, Loop& loop)
+{
+	if (node == nullptr)
+		return true;
+
+	switch (node->type) {
+	case Node::Type::FOR_STATEMENT:
+		// Iterating a generator resumes it.
+		if (((ForStatementNode*)node)->end_value == nullptr)
+			return false;
+
+		loop.written.insert(std::get<std::string>(node->token->value));
+		break;
+	case Node::Type::VARIABLE_ASSIGN:
+		loop.written.insert(std::get<std::string>(node->token->value));
+		break;
+	case Node::Type::INDEX_ASSIGN:
+	case Node::Type::PROPERTY_ASSIGN:
+		loop.mutates = true;
+		break;
+	case Node::Type::FN_DEFINITION:
+	case Node::Type::YIELD:
+		return false;
+	case Node::Type::FN_CALL: {
+		auto callee = ((FunctionCallNode*)node)->callee;
+
+		if (callee->type != Node::Type::VARIABLE_ACCESS)
+			return false;
+
+		auto& name = std::get<std::string>(callee->token->value);
+		auto native = bound.count(name) == 0 ? NativeFunction::find(name) : nullptr;
+
+		// Functions of the program may write anything, `list` resumes
+		// generators which run their code.
+		if (native == nullptr || name == "list")
+			return false;
+
+		if (pure_natives.count(name) == 0)
+			loop.mutates = true;
+
+		for (auto arg : native->args_names) {
+			if (arg != nullptr)
+				loop.written.insert(BaseFunction::optional_name(arg));
+		}
+
+		break;
+	}
+	default:
+		break;
+	}
+
+	for (auto slot : children(node)) {
+		if (!analyze(*slot, loop))
+			return false;
+	}
+
+	return true;
+}
+
+bool Optimizer::invariant(Node* node, const Loop& loop)
+{
+	auto unwritten = [&](const std::string& name) { return loop.written.count(name) == 0; };
+
+	switch (node->type) {
+	case Node::Type::NUMERIC:
+	case Node::Type::STRING:
+	case Node::Type::INVARIANT:
+		return true;
+	case Node::Type::VARIABLE_ACCESS:
+		return unwritten(std::get<std::string>(node->token->value));
+	case Node::Type::BINARY:
+		return invariant(node->left, loop) && invariant(node->right, loop);
+	case Node::Type::UNARY:
+		return invariant(((UnaryOperationNode*)node)->node, loop);
+	case Node::Type::INDEX_ACCESS:
+		return !loop.mutates && unwritten(std::get<std::string>(node->token->value)) && invariant(node->left, loop);
+	case Node::Type::PROPERTY_ACCESS:
+		return !loop.mutates && unwritten(((PropertyAccessNode*)node)->var_name);
+	case Node::Type::FN_CALL: {
+		bool reads = false;
+
+		if (!pure(node, reads) || (reads && loop.mutates))
+			return false;
+
+		for (auto arg : ((FunctionCallNode*)node)->args_nodes) {
+			if (!invariant(arg, loop))
+				return false;
+		}
+
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+unsigned int Optimizer::wrap(Node*& node, const Loop& loop, std::vector<InvariantNode*>& invariants)
+{
+	switch (node->type) {
+	case Node::Type::NUMERIC:
+	case Node::Type::STRING:
+	case Node::Type::VARIABLE_ACCESS:
+	case Node::Type::INVARIANT:
+	case Node::Type::INDUCTION:
+		return 0;
+	default:
+		break;
+	}
+
+	// A discarded value is never read, there is nothing to keep.
+	if (!node->discarded && node->token != nullptr && invariant(node, loop)) {
+		auto wrapped = new InvariantNode(node);
+		invariants.push_back(wrapped);
+		node = wrapped;
+
+		return 1;
+	}
+
+	unsigned int count = 0;
+
+	for (auto slot : children(node))
+		count += wrap(*slot, loop, invariants);
+
+	if (node->type == Node::Type::UNARY)
+		node->right = ((UnaryOperationNode*)node)->node;
+
+	return count;
+}
+
+unsigned int Optimizer::hoist(Node*& node)
+{
+	if (node == nullptr)
+		return 0;
+
+	unsigned int count = 0;
+	Loop loop;
+
+	// Outer loops first, what they hoist is kept across their inner loops.
+	if (node->type == Node::Type::FOR_STATEMENT && ((ForStatementNode*)node)->end_value != nullptr) {
+		auto for_node = (ForStatementNode*)node;
+		loop.written.insert(std::get<std::string>(for_node->token->value));
+
+		if (analyze(for_node->body, loop))
+			count += wrap(for_node->body, loop, for_node->invariants);
+	}
+	else if (node->type == Node::Type::WHILE_STATEMENT) {
+		auto while_node = (WhileStatementNode*)node;
+
+		if (analyze(while_node->condition, loop) && analyze(while_node->body, loop)) {
+			count += wrap(while_node->condition, loop, while_node->invariants);
+			count += wrap(while_node->body, loop, while_node->invariants);
+		}
+	}
+
+	for (auto slot : children(node))
+		count += hoist(*slot);
+
+	if (node->type == Node::Type::UNARY)
+		node->right = ((UnaryOperationNode*)node)->node;
+
+	return count;
+}
+
+unsigned int Optimizer::replace_products(Node*& node, const std::string& variable, std::vector<InductionNode*>& inductions)
+{
+	if (node->type == Node::Type::INVARIANT || node->type == Node::Type::INDUCTION)
+		return 0;
+
+	if (node->type == Node::Type::BINARY && node->token->type == Token::Type::MUL) {
+		auto factor = node->left->type == Node::Type::NUMERIC ? node->left : node->right;
+		auto operand = factor == node->left ? node->right : node->left;
+
+		if (factor->type == Node::Type::NUMERIC
+			&& factor->token->value.index() == 1
+			&& operand->type == Node::Type::VARIABLE_ACCESS
+			&& std::get<std::string>(operand->token->value) == variable) {
+			auto induction = new InductionNode(node, std::get<int>(factor->token->value));
+			inductions.push_back(induction);
+			node = induction;
+
+			return 1;
+		}
+	}
+
+	unsigned int count = 0;
+
+	for (auto slot : children(node))
+		count += replace_products(*slot, variable, inductions);
+
+	if (node->type == Node::Type::UNARY)
+		node->right = ((UnaryOperationNode*)node)->node;
+
+	return count;
+}
+
+unsigned int Optimizer::reduce(Node*& node)
+{
+	if (node == nullptr)
+		return 0;
+
+	unsigned int count = 0;
+
+	// Only numeric loops, the body must not write the loop variable.
+	if (node->type == Node::Type::FOR_STATEMENT && ((ForStatementNode*)node)->end_value != nullptr) {
+		auto for_node = (ForStatementNode*)node;
+		auto& variable = std::get<std::string>(for_node->token->value);
+		Loop loop;
+
+		if (analyze(for_node->body, loop) && loop.written.count(variable) == 0)
+			count += replace_products(for_node->body, variable, for_node->inductions);
+	}
+
+	for (auto slot : children(node))
+		count += reduce(*slot);
+
+	if (node->type == Node::Type::UNARY)
+		node->right = ((UnaryOperationNode*)node)->node;
+
+	return count;
+}
+
+bool Optimizer::verify(const std::vector<Node*>& program)
+{
+	std::set<Node*> seen;
+	std::vector<Node*> loops;
+
+	for (auto node : program) {
+		if (!check(node, seen, loops))
+			return false;
+	}
+
+	return true;
+}
+
+bool Optimizer::check(Node* node, std::set<Node*>& seen, std::vector<Node*>& loops)
+{
+	if (node == nullptr)
+		return true;
+
+	auto fail = [&](const std::string& reason) {
+		error = reason + " in " + node->typeToStr() + " node";
+		return false;
+	};
+
+	auto named = [](Node* named_node) {
+		return named_node->token != nullptr && named_node->token->value.index() == 3;
+	};
+
+	// Whether an enclosing loop keeps `registered` up to date.
+	auto registered = [&](Node* registered_node) {
+		for (auto loop : loops) {
+			auto for_node = loop->type == Node::Type::FOR_STATEMENT ? (ForStatementNode*)loop : nullptr;
+			auto& invariants = for_node != nullptr ? for_node->invariants : ((WhileStatementNode*)loop)->invariants;
+
+			if (std::find(invariants.begin(), invariants.end(), registered_node) != invariants.end())
+				return true;
+
+			if (for_node != nullptr && std::find(for_node->inductions.begin(), for_node->inductions.end(), registered_node) != for_node->inductions.end())
+				return true;
+		}
+
+		return false;
+	};
+
+	if (!seen.insert(node).second)
+		return fail("Shared child");
+
+	switch (node->type) {
+	case Node::Type::BINARY:
+		if (node->left == nullptr || node->right == nullptr)
+			return fail("Missing operand");
+
+		break;
+	case Node::Type::UNARY:
+		if (((UnaryOperationNode*)node)->node == nullptr || ((UnaryOperationNode*)node)->node != node->right)
+			return fail("Mismatched operand");
+
+		break;
+	case Node::Type::VARIABLE_ACCESS:
+	case Node::Type::INDEX_ACCESS:
+	case Node::Type::INDEX_ASSIGN:
+	case Node::Type::VARIABLE_ASSIGN:
+		if (!named(node))
+			return fail("Missing name");
+
+		break;
+	case Node::Type::FOR_STATEMENT: {
+		auto for_node = (ForStatementNode*)node;
+
+		if (!named(node) || for_node->start_value == nullptr || for_node->body == nullptr)
+			return fail("Incomplete loop");
+
+		if (for_node->end_value == nullptr && (!for_node->invariants.empty() || !for_node->inductions.empty()))
+			return fail("Optimized iteration");
+
+		break;
+	}
+	case Node::Type::WHILE_STATEMENT:
+		if (((WhileStatementNode*)node)->condition == nullptr || ((WhileStatementNode*)node)->body == nullptr)
+			return fail("Incomplete loop");
+
+		break;
+	case Node::Type::FN_CALL:
+		if (((FunctionCallNode*)node)->callee == nullptr)
+			return fail("Missing callee");
+
+		break;
+	case Node::Type::INVARIANT:
+		if (node->left == nullptr)
+			return fail("Missing value");
+
+		if (!registered(node))
+			return fail("Unregistered value");
+
+		break;
+	case Node::Type::INDUCTION:
+		if (node->left == nullptr || node->left->type != Node::Type::BINARY || node->left->token->type != Token::Type::MUL)
+			return fail("Missing product");
+
+		if (!registered(node))
+			return fail("Unregistered product");
+
+		break;
+	default:
+		break;
+	}
+
+	auto loop = node->type == Node::Type::FOR_STATEMENT || node->type == Node::Type::WHILE_STATEMENT;
+
+	if (loop)
+		loops.push_back(node);
+
+	for (auto slot : children(node)) {
+		if (!check(*slot, seen, loops))
+			return false;
+	}
+
+	if (!loop)
+		return true;
+
+	loops.pop_back();
+
+	// Every node the loop keeps up to date must be somewhere in it.
+	std::vector<Node*> kept;
+
+	if (node->type == Node::Type::FOR_STATEMENT) {
+		auto for_node = (ForStatementNode*)node;
+		kept.insert(kept.end(), for_node->invariants.begin(), for_node->invariants.end());
+		kept.insert(kept.end(), for_node->inductions.begin(), for_node->inductions.end());
+	}
+	else {
+		auto while_node = (WhileStatementNode*)node;
+		kept.insert(kept.end(), while_node->invariants.begin(), while_node->invariants.end());
+	}
+
+	for (auto kept_node : kept) {
+		if (seen.count(kept_node) == 0)
+			return fail("Detached value");
+	}
+
+	return true;
+}
@@ -2,10 +2,12 @@
 
 #include "Parser.h"
 #include "Profiler.h"
+#include "Metrics.h"
 #include "Utils.h"
 
 Parser::Parser() :
 	current_token(nullptr),
+	yields(0),
 	index(-1),
 	debug(false),
 	parsing_time(0.0)
@@ -17,8 +19,9 @@ Parser::Result* Parser::parse()
 	if (tokens.size() == 0)
 		return nullptr;
 
+	Allocations::Scope allocations(Allocations::Phase::PARSE);
 	Profiler profiler;
-	profiler.start = clock();
+	profiler.start = Profiler::now();
 	index = -1;
 
 	advance();
@@ -40,9 +43,17 @@ Parser::Result* Parser::parse()
 		}
 	}
 
-	profiler.end = clock();
+	profiler.end = Profiler::now();
 	parsing_time = profiler.getReport();
 
+	if (Profiler::enabled)
+		Profiler::record("parse", "phase", profiler.start, profiler.end);
+
+	Metrics::observePhase("parse", parsing_time);
+
+	if (result != nullptr && result->error != nullptr)
+		Metrics::countError(result->error->name);
+
 	return result;
 }
 
@@ -168,6 +179,21 @@ Parser::Result* Parser::expr()
 			return result->success(new VariableAssignmentNode(var_name, expression));
 		}
 
+		if (current_token->type == Token::Type::KEYWORD && value == "yield") {
+			Token* token = new Token(current_token);
+			result->record_advance();
+			advance();
+
+			Node* expression = result->record(expr());
+
+			if (result->error != nullptr)
+				return result;
+
+			yields++;
+
+			return result->success(new YieldNode(token, expression));
+		}
+
 		auto node = result->record(binary_operation([=]() {
 			return compare();
 		}, {
@@ -183,6 +209,24 @@ Parser::Result* Parser::expr()
 			));
 		}
 
+		if (current_token->type == Token::Type::EQ && (
+			node->type == Node::Type::INDEX_ACCESS ||
+			node->type == Node::Type::PROPERTY_ACCESS
+		)) {
+			result->record_advance();
+			advance();
+
+			Node* value = result->record(expr());
+
+			if (result->error != nullptr)
+				return result;
+
+			if (node->type == Node::Type::INDEX_ACCESS)
+				return result->success(new IndexAssignmentNode(node->token, node->left, value));
+
+			return result->success(new PropertyAssignmentNode(node->token, node, value));
+		}
+
 		return result->success(node);
 	}
 	
@@ -330,56 +374,75 @@ Parser::Result* Parser::for_expr()
 	result->record_advance();
 	advance();
 
-	if (current_token->type != Token::Type::EQ) {
+	Node* start_value = nullptr;
+	Node* end_value = nullptr;
+	Node* step = nullptr;
 
-		return result->failure(new InvalidSyntaxError(
-			current_token->start,
-			current_token->end,
-			"Expected '='"
-		));
-	}
+	std::string in_value;
+	try { in_value = std::get<std::string>(current_token->value); }
+	catch (const std::bad_variant_access&) {}
 
-	result->record_advance();
-	advance();
+	// `for x in iterable` leaves end_value null, see ForStatementNode.
+	if (current_token->type == Token::Type::KEYWORD && in_value == "in") {
+		result->record_advance();
+		advance();
 
-	auto start_value = result->record(expr());
+		start_value = result->record(expr());
 
-	if (result->error != nullptr)
-		return result;
+		if (result->error != nullptr)
+			return result;
+	}
+	else {
+		if (current_token->type != Token::Type::EQ) {
 
-	std::string to_value;
-	try { to_value = std::get<std::string>(current_token->value); }
-	catch (const std::bad_variant_access&) {}
+			return result->failure(new InvalidSyntaxError(
+				current_token->start,
+				current_token->end,
+				"Expected '=' or 'in'"
+			));
+		}
 
-	if (current_token->type != Token::Type::KEYWORD || to_value != "to") {
-		return result->failure(new InvalidSyntaxError(
-			current_token->start,
-			current_token->end,
-			"Expected 'to'"
-		));
-	}
+		result->record_advance();
+		advance();
 
-	result->record_advance();
-	advance();
+		start_value = result->record(expr());
 
-	auto end_value = result->record(expr());
-	Node* step = nullptr;
+		if (result->error != nullptr)
+			return result;
 
-	if (result->error != nullptr)
-		return result;
+		std::string to_value;
+		try { to_value = std::get<std::string>(current_token->value); }
+		catch (const std::bad_variant_access&) {}
 
-	std::string step_value;
-	try { step_value = std::get<std::string>(current_token->value); }
-	catch (const std::bad_variant_access&) {}
+		if (current_token->type != Token::Type::KEYWORD || to_value != "to") {
+			return result->failure(new InvalidSyntaxError(
+				current_token->start,
+				current_token->end,
+				"Expected 'to'"
+			));
+		}
 
-	if (current_token->type == Token::Type::KEYWORD && step_value == "step") {
 		result->record_advance();
 		advance();
 
-		step = result->record(expr());
+		end_value = result->record(expr());
 
 		if (result->error != nullptr)
 			return result;
+
+		std::string step_value;
+		try { step_value = std::get<std::string>(current_token->value); }
+		catch (const std::bad_variant_access&) {}
+
+		if (current_token->type == Token::Type::KEYWORD && step_value == "step") {
+			result->record_advance();
+			advance();
+
+			step = result->record(expr());
+
+			if (result->error != nullptr)
+				return result;
+		}
 	}
 
 	std::string then_value;
@@ -481,11 +544,6 @@ Parser::Result* Parser::atom()
 			result->record_advance();
 			advance();
 
-			while (current_token->type == Token::Type::COMMA) {
-				result->record_advance();
-				advance();
-			}
-
 			if (current_token->type == Token::Type::DOT) {
 				result->record_advance();
 				advance();
@@ -493,20 +551,26 @@ Parser::Result* Parser::atom()
 				auto prop_name = new Token(current_token);
 				std::vector<Token*> path = {};
 
-				path.push_back(new Token(current_token));
+				while (true) {
+					if (current_token->type != Token::Type::IDENTIFIER && current_token->type != Token::Type::KEYWORD) {
+						return result->failure(new InvalidSyntaxError(
+							current_token->start,
+							current_token->end,
+							"Expected Identifier"
+						));
+					}
 
-				result->record_advance();
-				advance();
+					path.push_back(new Token(current_token));
 
-				while (current_token->type == Token::Type::DOT) {
 					result->record_advance();
 					advance();
 
-					path.push_back(new Token(current_token));
-				}
+					if (current_token->type != Token::Type::DOT)
+						break;
 
-				result->record_advance();
-				advance();
+					result->record_advance();
+					advance();
+				}
 
 				return result->success(new PropertyAccessNode(
 					prop_name,
@@ -783,12 +847,19 @@ Parser::Result* Parser::function_definition()
 	result->record_advance();
 	advance();
 
+	// Yields inside a nested definition belong to that definition.
+	auto outer_yields = yields;
+	yields = 0;
+
 	auto return_node = result->record(expr());
+	auto generator = yields > 0;
+
+	yields = outer_yields;
 
 	if (result->error != nullptr)
 		return result;
 
-	return result->success(new FunctionDefinitionNode(args_names, return_node, fn_name));
+	return result->success(new FunctionDefinitionNode(args_names, return_node, fn_name, generator));
 }
 
 Parser::Result* Parser::function_call()
@@ -909,7 +980,7 @@ Parser::Result* Parser::array_expr()
 Parser::Result* Parser::map_expr()
 {
 	Result* result = new Result();
-	std::map<std::string, Node*> elements;
+	std::vector<std::pair<std::string, Node*>> elements;
 	std::shared_ptr<Cursor> start = std::make_shared<Cursor>(*current_token->start);
 
 	if (current_token->type != Token::Type::LCBRACKET) {
@@ -944,7 +1015,7 @@ Parser::Result* Parser::map_expr()
 		result->record_advance();
 		advance();
 
-		elements[std::get<std::string>(var_name->value)] = result->record(expr());
+		elements.emplace_back(std::get<std::string>(var_name->value), result->record(expr()));
 
 		if (result->error != nullptr) {
 			return result->failure(new InvalidSyntaxError(
@@ -975,7 +1046,7 @@ Parser::Result* Parser::map_expr()
 				result->record_advance();
 				advance();
 
-				elements[prop_name] = result->record(expr());
+				elements.emplace_back(prop_name, result->record(expr()));
 
 				if (result->error != nullptr)
 					return result;
@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "Profiler.h"
+
+bool Profiler::enabled = false;
+bool Profiler::tracing = false;
+std::map<std::string, Profiler::Stat> Profiler::stats;
+std::vector<Profiler::Event> Profiler::events;
+Profiler::Clock::time_point Profiler::origin = Profiler::Clock::now();
+
+Profiler::Scope::Scope(const std::string& name, const char* category) :
+	active(enabled),
+	category(category),
+	start()
+{
+	if (active) {
+		this->name = name;
+		start = Clock::now();
+	}
+}
+
+Profiler::Scope::~Scope()
+{
+	if (active)
+		record(name, category, start, Clock::now());
+}
+
+void Profiler::record(const std::string& name, const char* category, Clock::time_point start, Clock::time_point end)
+{
+	double elapsed = std::chrono::duration<double>(end - start).count();
+	auto it = stats.find(name);
+
+	if (it == stats.end()) {
+		stats.emplace(name, Stat{ category, 1, elapsed, elapsed, elapsed });
+	}
+	else {
+		Stat& stat = it->second;
+		stat.count++;
+		stat.total += elapsed;
+		stat.min = std::min(stat.min, elapsed);
+		stat.max = std::max(stat.max, elapsed);
+	}
+
+	if (tracing)
+		events.push_back({ name, category, start, end });
+}
+
+void Profiler::reset()
+{
+	stats.clear();
+	events.clear();
+	origin = Clock::now();
+}
+
+static void write_json_string(std::ostream& out, const std::string& str)
+{
+	out << '"';
+
+	for (char c : str) {
+		switch (c) {
+		case '"': out << "\\\""; break;
+		case '\\': out << "\\\\"; break;
+		case '\n': out << "\\n"; break;
+		case '\t': out << "\\t"; break;
+		default:
+			if ((unsigned char)c < 0x20) {
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				out << escaped;
+			}
+			else {
+				out << c;
+			}
+		}
+	}
+
+	out << '"';
+}
+
+bool Profiler::writeTrace(const std::string& path)
+{
+	using microseconds = std::chrono::duration<double, std::micro>;
+
+	std::ofstream out(path, std::ios::out | std::ios::trunc);
+
+	if (!out.is_open())
+		return false;
+
+	out.precision(3);
+	out << std::fixed << "{\"traceEvents\":[";
+
+	// Complete events ("ph":"X") nest by time range, so scopes that were
+	// recorded inner-first are still displayed as a proper call tree.
+	for (size_t i = 0; i < events.size(); ++i) {
+		const Event& event = events[i];
+
+		out << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+		write_json_string(out, event.name);
+		out << ",\"cat\":\"" << event.category << "\",\"ph\":\"X\""
+			<< ",\"ts\":" << microseconds(event.start - origin).count()
+			<< ",\"dur\":" << microseconds(event.end - event.start).count()
+			<< ",\"pid\":1,\"tid\":1}";
+	}
+
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	return out.good();
+}
@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "Range.h"
+#include "Number.h"
+#include "Str.h"
+#include "Coroutine.h"
+
+Range::Range(int start, int end, int step) :
+	type(Kind::NUMBERS),
+	first(start),
+	last(end),
+	increment(step),
+	count(0)
+{
+	long long distance = (long long)end - start;
+
+	if (step > 0 && distance > 0)
+		count = (size_t)((distance + step - 1) / step);
+	else if (step < 0 && distance < 0)
+		count = (size_t)((-distance - step - 1) / -(long long)step);
+}
+
+Range::Range(Kind kind, const Source& source) :
+	type(kind),
+	first(0),
+	last(0),
+	increment(1),
+	count(0),
+	origin(source)
+{
+}
+
+Range::Range(std::shared_ptr<Coroutine> stream) :
+	type(Kind::STREAM),
+	first(0),
+	last(0),
+	increment(1),
+	count(0),
+	origin(stream)
+{
+}
+
+Coroutine* Range::stream() const
+{
+	auto coroutine = std::get_if<std::shared_ptr<Coroutine>>(&origin);
+	return coroutine != nullptr ? coroutine->get() : nullptr;
+}
+
+size_t Range::size() const
+{
+	switch (origin.index()) {
+	case 1:
+		return std::get<ArrayStorage>(origin).size();
+	case 2:
+		return std::get<MapStorage>(origin).size();
+	case 3:
+		return std::get<SharedString>(origin).size();
+	default:
+		return count;
+	}
+}
+
+Type* Range::at(size_t index) const
+{
+	if (type == Kind::NUMBERS)
+		return new Number(first + (int)index * increment);
+
+	if (type == Kind::STREAM)
+		return nullptr;
+
+	if (type == Kind::CHARACTERS)
+		return new String(SharedString(std::get<SharedString>(origin).view().substr(index, 1)));
+
+	if (auto array = std::get_if<ArrayStorage>(&origin))
+		return type == Kind::KEYS ? new Number((int)index) : array->at(index);
+
+	auto& entry = std::get<MapStorage>(origin).entries().at(index);
+
+	return type == Kind::KEYS ? new String(SharedString(entry.key)) : entry.value;
+}
+
+std::string Range::describe() const
+{
+	if (type == Kind::NUMBERS)
+		return "range(" + std::to_string(first) + ", " + std::to_string(last) + ", " + std::to_string(increment) + ")";
+
+	if (type == Kind::STREAM)
+		return "<generator>";
+
+	std::string source = origin.index() == 1 ? "array" : origin.index() == 2 ? "map" : "string";
+	std::string name = type == Kind::KEYS ? "keys" : type == Kind::VALUES ? "values" : "chars";
+
+	return name + "(<" + source + ">)";
+}
+
+bool operator==(const Range& a, const Range& b)
+{
+	if (a.type != b.type || a.origin.index() != b.origin.index())
+		return false;
+
+	switch (a.origin.index()) {
+	case 1:
+		return std::get<ArrayStorage>(a.origin).shares(std::get<ArrayStorage>(b.origin));
+	case 2:
+		return std::get<MapStorage>(a.origin).shares(std::get<MapStorage>(b.origin));
+	case 3:
+		return std::get<SharedString>(a.origin) == std::get<SharedString>(b.origin);
+	case 4:
+		return a.stream() == b.stream();
+	default:
+		return a.first == b.first && a.last == b.last && a.increment == b.increment;
+	}
+}
@@ -0,0 +1,116 @@
+#include "pch.h"
+#include "Sampler.h"
+
+#include <thread>
+
+bool Sampler::running = false;
+std::atomic<unsigned int> Sampler::ticks(0);
+std::vector<Sampler::Frame> Sampler::frames;
+std::unordered_map<std::string, unsigned long long> Sampler::samples;
+unsigned long long Sampler::total = 0;
+
+static std::atomic<bool> ticking(false);
+static std::thread ticker;
+
+Sampler::Call::Call(const std::string& name, int line) :
+	active(running)
+{
+	if (!active)
+		return;
+
+	if (line >= 0)
+		frames.back().line = line;
+
+	frames.push_back({ name, -1 });
+}
+
+Sampler::Call::~Call()
+{
+	if (!active)
+		return;
+
+	// Time spent inside natives is only visible here, take the pending
+	// sample before the frame disappears.
+	if (ticks.load(std::memory_order_relaxed) != 0)
+		sample(frames.back().line);
+
+	frames.pop_back();
+}
+
+void Sampler::start(std::chrono::microseconds interval)
+{
+	if (running)
+		return;
+
+	if (frames.empty())
+		frames.push_back({ "<program>", -1 });
+
+	running = true;
+	ticking = true;
+
+	ticker = std::thread([interval]() {
+		while (ticking.load(std::memory_order_relaxed)) {
+			std::this_thread::sleep_for(interval);
+			ticks.fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+}
+
+void Sampler::stop()
+{
+	if (!running)
+		return;
+
+	ticking = false;
+	ticker.join();
+	running = false;
+	ticks = 0;
+}
+
+void Sampler::reset()
+{
+	samples.clear();
+	total = 0;
+	ticks = 0;
+}
+
+void Sampler::sample(int line)
+{
+	unsigned int weight = ticks.exchange(0, std::memory_order_relaxed);
+
+	if (weight == 0 || frames.empty())
+		return;
+
+	if (line >= 0)
+		frames.back().line = line;
+
+	std::string stack;
+
+	for (size_t i = 0; i < frames.size(); ++i) {
+		if (i > 0)
+			stack += ';';
+
+		stack += frames[i].name;
+
+		if (frames[i].line >= 0)
+			stack += ":" + std::to_string(frames[i].line + 1);
+	}
+
+	samples[stack] += weight;
+	total += weight;
+}
+
+bool Sampler::write(const std::string& path)
+{
+	std::ofstream out(path, std::ios::out | std::ios::trunc);
+
+	if (!out.is_open())
+		return false;
+
+	// Collapsed stacks, one "frame;frame;frame count" per line, as read by
+	// flamegraph.pl, inferno or speedscope.
+	for (auto& sample : samples)
+		out << sample.first << ' ' << sample.second << '\n';
+
+	return out.good();
+}
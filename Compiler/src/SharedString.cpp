@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "SharedString.h"
+
+static std::unordered_map<std::string_view, SharedString>& internTable()
+{
+	static std::unordered_map<std::string_view, SharedString> table;
+	return table;
+}
+
+SharedString::SharedString() :
+	small(0)
+{
+	buffer[0] = '\0';
+}
+
+SharedString::SharedString(const char* text) :
+	small(0)
+{
+	assign(std::string_view(text));
+}
+
+SharedString::SharedString(const std::string& text) :
+	small(0)
+{
+	assign(std::string_view(text));
+}
+
+SharedString::SharedString(std::string_view text) :
+	small(0)
+{
+	assign(text);
+}
+
+SharedString::SharedString(const SharedString& other) :
+	small(other.small)
+{
+	if (small == HEAP) {
+		block = other.block;
+		block->references++;
+	}
+	else {
+		std::memcpy(buffer, other.buffer, sizeof(buffer));
+	}
+}
+
+SharedString::SharedString(SharedString&& other) noexcept :
+	small(other.small)
+{
+	std::memcpy(buffer, other.buffer, sizeof(buffer));
+	other.small = 0;
+	other.buffer[0] = '\0';
+}
+
+SharedString::~SharedString()
+{
+	release();
+}
+
+SharedString& SharedString::operator=(const SharedString& other)
+{
+	if (this == &other)
+		return *this;
+
+	if (other.small == HEAP)
+		other.block->references++;
+
+	release();
+	small = other.small;
+	std::memcpy(buffer, other.buffer, sizeof(buffer));
+
+	return *this;
+}
+
+SharedString& SharedString::operator=(SharedString&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	release();
+	small = other.small;
+	std::memcpy(buffer, other.buffer, sizeof(buffer));
+	other.small = 0;
+	other.buffer[0] = '\0';
+
+	return *this;
+}
+
+const char* SharedString::data() const
+{
+	return small == HEAP ? block->text : buffer;
+}
+
+size_t SharedString::size() const
+{
+	return small == HEAP ? block->size : small;
+}
+
+void SharedString::append(std::string_view text)
+{
+	auto current = size();
+	auto total = current + text.size();
+
+	if (small != HEAP && total <= INLINE_CAPACITY) {
+		std::memcpy(buffer + current, text.data(), text.size());
+		buffer[total] = '\0';
+		small = (unsigned char)total;
+		return;
+	}
+
+	if (small == HEAP && block->references == 1 && block->capacity >= total) {
+		std::memcpy(block->text + current, text.data(), text.size());
+		block->text[total] = '\0';
+		block->size = total;
+		return;
+	}
+
+	// A block we own outgrew its capacity: grow geometrically so repeated
+	// appends stay amortized linear. Shared text is copied at its exact size.
+	auto capacity = small == HEAP && block->references == 1
+		? std::max(total, block->capacity * 2)
+		: total;
+
+	auto grown = allocate(capacity);
+	std::memcpy(grown->text, data(), current);
+	std::memcpy(grown->text + current, text.data(), text.size());
+	grown->text[total] = '\0';
+	grown->size = total;
+
+	release();
+	block = grown;
+	small = HEAP;
+}
+
+void SharedString::reserve(size_t capacity)
+{
+	if (capacity <= INLINE_CAPACITY)
+		return;
+
+	if (small == HEAP && block->references == 1 && block->capacity >= capacity)
+		return;
+
+	auto current = size();
+	auto grown = allocate(std::max(capacity, current));
+	std::memcpy(grown->text, data(), current);
+	grown->text[current] = '\0';
+	grown->size = current;
+
+	release();
+	block = grown;
+	small = HEAP;
+}
+
+bool SharedString::isInline() const
+{
+	return small != HEAP;
+}
+
+size_t SharedString::references() const
+{
+	return small == HEAP ? block->references : 1;
+}
+
+SharedString SharedString::intern(std::string_view text)
+{
+	if (text.size() <= INLINE_CAPACITY)
+		return SharedString(text);
+
+	auto& table = internTable();
+	auto it = table.find(text);
+
+	if (it != table.end())
+		return it->second;
+
+	// The table keeps its own reference, the key views the block's text.
+	SharedString string(text);
+	table.emplace(string.view(), string);
+
+	return string;
+}
+
+size_t SharedString::interned()
+{
+	return internTable().size();
+}
+
+SharedString SharedString::concat(std::string_view left, std::string_view right)
+{
+	SharedString string;
+	string.reserve(left.size() + right.size());
+	string.append(left);
+	string.append(right);
+
+	return string;
+}
+
+SharedString::Block* SharedString::allocate(size_t capacity)
+{
+	auto block = (Block*)::operator new(sizeof(Block) + capacity);
+	block->references = 1;
+	block->size = 0;
+	block->capacity = capacity;
+	block->text[0] = '\0';
+
+	return block;
+}
+
+void SharedString::assign(std::string_view text)
+{
+	if (text.size() <= INLINE_CAPACITY) {
+		std::memcpy(buffer, text.data(), text.size());
+		buffer[text.size()] = '\0';
+		small = (unsigned char)text.size();
+		return;
+	}
+
+	block = allocate(text.size());
+	std::memcpy(block->text, text.data(), text.size());
+	block->text[text.size()] = '\0';
+	block->size = text.size();
+	small = HEAP;
+}
+
+void SharedString::release()
+{
+	if (small == HEAP && --block->references == 0)
+		::operator delete(block);
+
+	small = 0;
+	buffer[0] = '\0';
+}
+
+bool operator==(const SharedString& a, const SharedString& b)
+{
+	return a.view() == b.view();
+}
+
+bool operator!=(const SharedString& a, const SharedString& b)
+{
+	return a.view() != b.view();
+}
+
+bool operator<(const SharedString& a, const SharedString& b)
+{
+	return a.view() < b.view();
+}
+
+bool operator>(const SharedString& a, const SharedString& b)
+{
+	return a.view() > b.view();
+}
+
+bool operator<=(const SharedString& a, const SharedString& b)
+{
+	return a.view() <= b.view();
+}
+
+bool operator>=(const SharedString& a, const SharedString& b)
+{
+	return a.view() >= b.view();
+}
+
+std::ostream& operator<<(std::ostream& stream, const SharedString& string)
+{
+	return stream.write(string.data(), string.size());
+}
@@ -25,6 +25,7 @@ std::unordered_map<std::string, std::string> String::constants = {
 String::String(const DynamicType& value) :
 	Type(value)
 {
+	Allocations::refine(Allocations::Kind::STRING, sizeof(String));
 }
 
 std::pair<Type*, Error*> String::add(Type* other)
@@ -32,22 +33,22 @@ std::pair<Type*, Error*> String::add(Type* other)
 	auto str = new String();
 
 	if(other->value.index() == Type::Native::DOUBLE) {
-		try { str->value = std::get<std::string>(value) + std::to_string(std::get<double>(other->value)); }
+		try { str->value = SharedString::concat(std::get<SharedString>(value), std::to_string(std::get<double>(other->value))); }
 		catch (const std::bad_variant_access&) {}
 	}
 
 	if (other->value.index() == Type::Native::INT) {
-		try { str->value = std::get<std::string>(value) + std::to_string(std::get<int>(other->value)); }
+		try { str->value = SharedString::concat(std::get<SharedString>(value), std::to_string(std::get<int>(other->value))); }
 		catch (const std::bad_variant_access&) {}
 	}
 
 	if (other->value.index() == Type::Native::BOOL) {
-		try { str->value = std::get<std::string>(value) + std::to_string(std::get<bool>(other->value)); }
+		try { str->value = SharedString::concat(std::get<SharedString>(value), std::to_string(std::get<bool>(other->value))); }
 		catch (const std::bad_variant_access&) {}
 	}
 
 	if (other->value.index() == Type::Native::STRING) {
-		try { str->value = std::get<std::string>(value) + std::get<std::string>(other->value); }
+		try { str->value = SharedString::concat(std::get<SharedString>(value), std::get<SharedString>(other->value)); }
 		catch (const std::bad_variant_access&) {}
 	}
 
@@ -59,11 +60,15 @@ std::pair<Type*, Error*> String::multiply(Type* other)
 	auto str = new String();
 
 	if (other->value.index() == Type::Native::INT) {
-		std::string out;
+		SharedString out;
+		auto& text = std::get<SharedString>(value);
 		auto n = std::get<int>(other->value);
 
-		while (n--) {
-			out += std::get<std::string>(value);
+		if (n > 0)
+			out.reserve(text.size() * n);
+
+		while (n-- > 0) {
+			out.append(text);
 		}
 
 		str->value = out;
@@ -77,7 +82,7 @@ std::pair<Type*, Error*> String::compare_equal(Type* other)
 	auto result = new Number(false);
 
 	if (other->value.index() == Type::Native::STRING) {
-		try { result->value = (bool)(std::get<std::string>(value) == std::get<std::string>(other->value)); }
+		try { result->value = (bool)(std::get<SharedString>(value) == std::get<SharedString>(other->value)); }
 		catch (const std::bad_variant_access&) {}
 	}
 
@@ -89,7 +94,7 @@ std::pair<Type*, Error*> String::compare_not_equal(Type* other)
 	auto result = new Number(false);
 
 	if (other->value.index() == Type::Native::STRING) {
-		try { result->value = (bool)(std::get<std::string>(value) != std::get<std::string>(other->value)); }
+		try { result->value = (bool)(std::get<SharedString>(value) != std::get<SharedString>(other->value)); }
 		catch (const std::bad_variant_access&) {}
 	}
 
@@ -101,7 +106,7 @@ std::pair<Type*, Error*> String::compare_less_than(Type* other)
 	auto result = new Number(false);
 
 	if (other->value.index() == Type::Native::STRING) {
-		try { result->value = (bool)(std::get<std::string>(value).size() < std::get<std::string>(other->value).size()); }
+		try { result->value = (bool)(std::get<SharedString>(value).size() < std::get<SharedString>(other->value).size()); }
 		catch (const std::bad_variant_access&) {}
 	}
 
@@ -113,7 +118,7 @@ std::pair<Type*, Error*> String::compare_greater_than(Type* other)
 	auto result = new Number(false);
 
 	if (other->value.index() == Type::Native::STRING) {
-		try { result->value = (bool)(std::get<std::string>(value).size() > std::get<std::string>(other->value).size()); }
+		try { result->value = (bool)(std::get<SharedString>(value).size() > std::get<SharedString>(other->value).size()); }
 		catch (const std::bad_variant_access&) {}
 	}
 
@@ -125,7 +130,7 @@ std::pair<Type*, Error*> String::compare_less_or_equal(Type* other)
 	auto result = new Number(false);
 
 	if (other->value.index() == Type::Native::STRING) {
-		try { result->value = (bool)(std::get<std::string>(value).size() <= std::get<std::string>(other->value).size()); }
+		try { result->value = (bool)(std::get<SharedString>(value).size() <= std::get<SharedString>(other->value).size()); }
 		catch (const std::bad_variant_access&) {}
 	}
 
@@ -137,7 +142,7 @@ std::pair<Type*, Error*> String::compare_greater_or_equal(Type* other)
 	auto result = new Number(false);
 
 	if (other->value.index() == Type::Native::STRING) {
-		try { result->value = (bool)(std::get<std::string>(value).size() >= std::get<std::string>(other->value).size()); }
+		try { result->value = (bool)(std::get<SharedString>(value).size() >= std::get<SharedString>(other->value).size()); }
 		catch (const std::bad_variant_access&) {}
 	}
 
@@ -2,13 +2,23 @@
 #include "Symbols.h"
 #include "Function.h"
 
+uint64_t Symbols::version = 1;
+std::unordered_set<std::string> Symbols::callees;
+
 Symbols::Symbols(Symbols* parent) :
 	symbols({}),
-	parent(parent)
+	parent(parent),
+	functions(false)
 {
 
 }
 
+Symbols::~Symbols()
+{
+	if (functions)
+		version++;
+}
+
 Symbols::SymbolsMap::iterator Symbols::get(const std::string& name)
 {
 	SymbolsMap::iterator it = symbols.find(name);
@@ -16,16 +26,65 @@ Symbols::SymbolsMap::iterator Symbols::get(const std::string& name)
 	if (it == symbols.end() && parent != nullptr)
 		return parent->get(name);
 
+	// Names unknown to the whole chain are offered to the resolver once,
+	// this is how the global scope materializes builtins on first use.
+	if (it == symbols.end() && resolver != nullptr) {
+		DynamicType value;
+
+		if (resolver(name, value))
+			it = symbols.emplace(name, value).first;
+	}
+
 	return it;
 }
 
 void Symbols::set(const std::string& name, DynamicType value)
 {
-	symbols[name] = value;
+	auto it = symbols.find(name);
+	auto bound = it != symbols.end();
+
+	if (value.index() == Type::Native::FUNCTION || (bound && it->second.index() == Type::Native::FUNCTION)) {
+		functions = true;
+		version++;
+	}
+	else if (!bound && callees.count(name) != 0) {
+		// A new local hiding a function takes it away from the call sites
+		// that cached it. Only names some call site cached are looked up.
+		auto outer = shadowed(name);
+
+		if (outer != nullptr && outer->index() == Type::Native::FUNCTION)
+			version++;
+	}
+
+	if (bound)
+		it->second = std::move(value);
+	else
+		symbols.emplace(name, std::move(value));
+}
+
+const DynamicType* Symbols::shadowed(const std::string& name) const
+{
+	for (auto scope = parent; scope != nullptr; scope = scope->parent) {
+		auto it = scope->symbols.find(name);
+
+		if (it != scope->symbols.end())
+			return &it->second;
+	}
+
+	return nullptr;
 }
 
 bool Symbols::remove(const std::string& name)
 {
-	return symbols.erase(name) == 1;
+	auto it = symbols.find(name);
+
+	if (it == symbols.end())
+		return false;
+
+	if (it->second.index() == Type::Native::FUNCTION)
+		version++;
+
+	symbols.erase(it);
+	return true;
 }
 
@@ -14,6 +14,8 @@ std::vector<std::string> Token::keywords = {
 	"while",
 	"to",
 	"step",
+	"in",
+	"yield",
 	"function",
 	"import",
 	"break",
@@ -33,6 +35,8 @@ Token::Token(
     start(start),
     end(end)
 {
+    Allocations::record(Allocations::Kind::TOKEN, sizeof(Token));
+
     if (start != nullptr) {
         this->start = start;
         this->end = start;
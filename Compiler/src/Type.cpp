@@ -26,9 +26,28 @@ Type::Type(
 	this->end = end;
 	this->context = context;
 	this->depth = 0;
+
+	Allocations::record(Allocations::Kind::TYPE, sizeof(Type));
+}
+
+Type* Type::from(const DynamicType& value)
+{
+	switch (value.index()) {
+	case Native::STRING:
+		return new String(value);
+	case Native::ARRAY:
+		return new Array(value);
+	case Native::MAP:
+		return new Map(value);
+	case Native::FILE:
+	case Native::RANGE:
+		return new Type(value);
+	default:
+		return new Number(value);
+	}
 }
 
-RuntimeResult* Type::execute(const std::vector<Type*>& args, Context* context)
+RuntimeResult* Type::execute(const std::vector<Type*>& args, Context* context, bool /*checked*/)
 {
 	return nullptr;
 }
@@ -99,7 +118,7 @@ std::pair<Type*, Error*> Type::is_true() {
 
 void Type::printArray(std::ostream& stream, Array* array)
 {
-	auto elements = std::get<std::vector<Type*>>(array->value);
+	auto elements = std::get<ArrayStorage>(array->value).elements();
 	std::vector<Type*>::iterator it = elements.begin();
 
 	stream << std::string(array->depth, ' ') << "[" << '\n';
@@ -122,7 +141,7 @@ void Type::printFunction(std::ostream& stream, Function* function)
 
 void Type::printString(std::ostream& stream, String* string)
 {
-	try { stream << '"' << std::get<std::string>(string->value) << '"'; }
+	try { stream << '"' << std::get<SharedString>(string->value) << '"'; }
 	catch (const std::bad_variant_access&) {}
 }
 
@@ -150,17 +169,16 @@ void Type::printFile(std::ostream& stream, File* file)
 
 void Type::printMap(std::ostream& stream, Map* map)
 {
-	auto elements = std::get<std::map<std::string, Type*>>(map->value);
-	std::map<std::string, Type*>::reverse_iterator it = elements.rbegin();
+	auto& elements = std::get<MapStorage>(map->value).entries();
 
 	stream << std::string(map->depth, ' ') << "{" << '\n';
 	map->depth += 4;
 
-	for (unsigned int i = 0; it != elements.rend(); ++it, i++) {
+	for (unsigned int i = 0; i < elements.size(); i++) {
 		auto comma = i != elements.size() - 1 ? ',' : '\0';
 
 		stream << std::string(map->depth + 4, ' ') <<
-			it->first << ": " << it->second << comma << '\n';
+			elements[i].key << ": " << elements[i].value << comma << '\n';
 	}
 
 	stream << std::string(map->depth, ' ') << "}";
@@ -189,8 +207,10 @@ std::ostream& operator << (std::ostream& stream, Type* type)
 			Type::printFunction(stream, function);
 		else if (String* string = dynamic_cast<String*>(type))
 			Type::printString(stream, string);
-		else if (File* file = (File*)type)
-			Type::printFile(stream, std::get<File*>(file->value));
+		else if (type->value.index() == Type::Native::RANGE)
+			stream << std::get<Range>(type->value).describe();
+		else if (type->value.index() == Type::Native::FILE)
+			Type::printFile(stream, std::get<File*>(type->value));
 	/*	else if (Object* object = (Object*)type)
 			Type::printObject(stream, std::get<Object*>(object->value));*/
 	}
@@ -2,6 +2,7 @@
 #include <string>
 #include <cstring>
 #include <string.h>
+#include <chrono>
 #include <BirdLang.h>
 
 #ifdef PLATFORM_WINDOWS
@@ -9,34 +10,58 @@
 #endif
 
 int main(int argc, char** argv) {
+	auto launched = std::chrono::steady_clock::now();
+
 #ifdef PLATFORM_WINDOWS
 	SetConsoleTitle(L"Bird Lang Interpreter");
 #endif
 
-	std::cout << R"(
-       _________
-      /_  ___   \
-     /  \/   \   \
-     \@_/\@__/   /
-      \_\/______/
-      /     /\\\\\
-     |     |\\\\\\
-      \      \\\\\\
-       \______/\\\\
- _______ ||_||_______
-(______(((_(((______(@)
-|                     |
-|      BIRD LANG      |
-|     INTERPRETER     |
-|_____________________|
-)";
-
 	bool debug_lexer = false;
 	bool debug_parser = false;
 	bool profiling = false;
+	bool caching = false;
+	bool startup_stats = false;
+	bool sampling = false;
+	bool instrumenting = false;
+	bool optimizing = false;
+	bool benchmarking = false;
+	bool benchmark_json = false;
+	unsigned int benchmark_runs = 100;
+	unsigned int benchmark_warmup = 5;
+	std::string trace_path;
+	std::string metrics_path;
+	std::string aot_output;
+	std::string filename;
 
-	for (int i = 0; i < argc; ++i) {
-		if (strstr(argv[i], "-") == argv[i]) {
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--startup-stats") == 0) {
+			startup_stats = true;
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			trace_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+			metrics_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--aot") == 0 && i + 1 < argc) {
+			aot_output = argv[++i];
+		}
+		else if (strcmp(argv[i], "--no-jit") == 0) {
+			Jit::enabled = false;
+		}
+		else if (strcmp(argv[i], "--bench") == 0) {
+			benchmarking = true;
+		}
+		else if (strcmp(argv[i], "--json") == 0) {
+			benchmark_json = true;
+		}
+		else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+			benchmark_runs = (unsigned int)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+			benchmark_warmup = (unsigned int)atoi(argv[++i]);
+		}
+		else if (strstr(argv[i], "-") == argv[i]) {
 			for (unsigned int j = 1; j < strlen(argv[i]); j++) {
 				if (argv[i][j] == 'l')
 					debug_lexer = true;
@@ -44,16 +69,77 @@ int main(int argc, char** argv) {
 					debug_parser = true;
 				else if (argv[i][j] == 's')
 					profiling = true;
+				else if (argv[i][j] == 'c')
+					caching = true;
+				else if (argv[i][j] == 'P')
+					sampling = true;
+				else if (argv[i][j] == 'A')
+					instrumenting = true;
+				else if (argv[i][j] == 'O')
+					optimizing = true;
 			}
 		}
+		else {
+			filename = argv[i];
+		}
 	}
 
 	std::unique_ptr<Compiler> compiler = std::make_unique<Compiler>(
 		debug_lexer,
 		debug_parser,
-		profiling
+		profiling,
+		caching,
+		startup_stats
 	);
 
+	compiler->launched = launched;
+
+	if (!trace_path.empty())
+		compiler->enableTracing(trace_path);
+
+	if (instrumenting)
+		compiler->enableInstrumentation();
+
+	if (optimizing)
+		compiler->enableOptimizations();
+
+	if (!metrics_path.empty())
+		compiler->enableMetrics(metrics_path);
+
+	if (sampling)
+		compiler->enableSampling(filename.empty() ? "birdlang.folded" : filename + ".folded");
+
+	if (!aot_output.empty() && !filename.empty())
+		return compiler->compileToExecutable(filename, aot_output) ? 0 : 1;
+
+	if (benchmarking && !filename.empty()) {
+		compiler->benchmarkFile(filename, benchmark_runs, benchmark_warmup, benchmark_json);
+		return 0;
+	}
+
+	if (!filename.empty()) {
+		compiler->interpretFile(filename);
+		return 0;
+	}
+
+	std::cout << R"(
+       _________
+      /_  ___   \
+     /  \/   \   \
+     \@_/\@__/   /
+      \_\/______/
+      /     /\\\\\
+     |     |\\\\\\
+      \      \\\\\\
+       \______/\\\\
+ _______ ||_||_______
+(______(((_(((______(@)
+|                     |
+|      BIRD LANG      |
+|     INTERPRETER     |
+|_____________________|
+)";
+
 	while (true)
 	{
 		std::cout << "\n" << "> ";
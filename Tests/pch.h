@@ -6,3 +6,18 @@
 #include "../Compiler/include/Parser.h"
 #include "../Compiler/include/Interpreter.h"
 #include "../Compiler/include/Number.h"
+#include "../Compiler/include/Str.h"
+#include "../Compiler/include/Array.h"
+#include "../Compiler/include/Map.h"
+#include "../Compiler/include/Kernels.h"
+#include "../Compiler/include/Coroutine.h"
+#include "../Compiler/include/Function.h"
+#include "../Compiler/include/NativeFunction.h"
+#include "../Compiler/include/Cache.h"
+#include "../Compiler/include/Generator.h"
+#include "../Compiler/include/Optimizer.h"
+#include "../Compiler/include/Profiler.h"
+#include "../Compiler/include/Sampler.h"
+#include "../Compiler/include/Instrumentation.h"
+#include "../Compiler/include/Allocations.h"
+#include "../Compiler/include/Metrics.h"
@@ -6,6 +6,14 @@
 #include "tests/Symbols.h"
 #include "tests/Context.h"
 #include "tests/Types.h"
+#include "tests/Cache.h"
+#include "tests/Generator.h"
+#include "tests/Optimizer.h"
+#include "tests/Profiler.h"
+#include "tests/Sampler.h"
+#include "tests/Instrumentation.h"
+#include "tests/Allocations.h"
+#include "tests/Metrics.h"
 
 int main(int argc, char** argv) {
 	::testing::InitGoogleTest(&argc, argv);
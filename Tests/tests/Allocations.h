@@ -0,0 +1,24 @@
+#pragma once
+
+TEST(Allocations, CountsPerKindAndPhase) {
+	Allocations::reset();
+
+	Lexer lexer("test");
+	Parser parser;
+	parser.setTokens(lexer.index_tokens("1 + 2"));
+	auto ast = parser.parse();
+
+	EXPECT_EQ(Allocations::stats[Allocations::Phase::LEX][Allocations::Kind::TOKEN].count, 4);
+	EXPECT_EQ(Allocations::stats[Allocations::Phase::PARSE][Allocations::Kind::NODE + Node::Type::NUMERIC].count, 2);
+	EXPECT_EQ(Allocations::stats[Allocations::Phase::PARSE][Allocations::Kind::NODE + Node::Type::BINARY].count, 1);
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+	interp->visit(ast->node, ctx);
+
+	auto numbers = Allocations::stats[Allocations::Phase::EVAL][Allocations::Kind::NUMBER];
+	EXPECT_EQ(numbers.count, 3);
+	EXPECT_EQ(numbers.bytes, 3 * sizeof(Number));
+	EXPECT_EQ(Allocations::total(Allocations::Kind::TYPE).count, 0);
+}
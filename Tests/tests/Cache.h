@@ -0,0 +1,41 @@
+#pragma once
+
+TEST(Cache, HashIsContentKeyed) {
+	EXPECT_EQ(Cache::hash("var a = 1"), Cache::hash("var a = 1"));
+	EXPECT_NE(Cache::hash("var a = 1"), Cache::hash("var a = 2"));
+}
+
+TEST(Cache, StoreAndLoadProgram) {
+	Lexer lexer("test");
+	Parser parser;
+	parser.setTokens(lexer.index_tokens("var a = 1 + 2 * 3"));
+	auto ast = parser.parse();
+
+	auto directory = (std::filesystem::temp_directory_path() / "birdlang-tests").string();
+	Cache cache(directory);
+	auto key = Cache::hash("var a = 1 + 2 * 3");
+
+	EXPECT_TRUE(cache.store(key, { ast->node }));
+
+	std::vector<Node*> program;
+	EXPECT_TRUE(cache.load(key, "test", program));
+	EXPECT_EQ(cache.hits, 1);
+	ASSERT_EQ(program.size(), 1);
+	EXPECT_EQ(program.at(0)->type, Node::Type::VARIABLE_ASSIGN);
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+
+	auto result = interp->visit(program.at(0), ctx);
+	EXPECT_EQ(std::get<int>(result->value->value), 7);
+}
+
+TEST(Cache, MissOnUnknownKey) {
+	auto directory = (std::filesystem::temp_directory_path() / "birdlang-tests").string();
+	Cache cache(directory);
+	std::vector<Node*> program;
+
+	EXPECT_FALSE(cache.load(Cache::hash("never stored"), "test", program));
+	EXPECT_EQ(cache.misses, 1);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+TEST(Generator, EmitsConstructorsForEveryStatement) {
+	std::vector<Node*> program;
+
+	for (auto line : {
+		"function twice(n) -> n * 2",
+		"var cfg = {name: \"a\\\"b\"}",
+		"for i = 0 to 3 then cfg.name"
+	}) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		program.push_back(parser.parse()->node);
+	}
+
+	Generator generator;
+	std::string source;
+
+	ASSERT_TRUE(generator.emit(program, "test.bird", source));
+	EXPECT_NE(source.find("static Node* statement2()"), std::string::npos);
+	EXPECT_NE(source.find("new FunctionDefinitionNode("), std::string::npos);
+	EXPECT_NE(source.find("new PropertyAccessNode("), std::string::npos);
+	EXPECT_NE(source.find("\"a\\\"b\""), std::string::npos);
+	EXPECT_NE(source.find("compiler.run(program)"), std::string::npos);
+}
+
+TEST(Generator, EmitsNativeCodeForTheJitSubset) {
+	std::vector<Node*> program;
+
+	for (auto line : {
+		"var acc = 0",
+		"for i = 0 to 10 then var acc = acc + i * 2",
+		"function fib(n) -> if n < 2 then n else fib(n - 1) + fib(n - 2)",
+		"for x in [1, 2] then var acc = acc + x",
+		"function half(n) -> n / 2"
+	}) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		program.push_back(parser.parse()->node);
+	}
+
+	Generator generator;
+	std::string source;
+
+	// The for-in loop and the division stay interpreted.
+	ASSERT_TRUE(generator.emit(program, "test.bird", source));
+	EXPECT_EQ(generator.compiled, 2u);
+	EXPECT_NE(source.find("static int loop0(int64_t* slots)"), std::string::npos);
+	EXPECT_NE(source.find("v3 = add32(v3, multiply32(v0, 2));"), std::string::npos);
+	EXPECT_NE(source.find("function1_body(subtract32(v0, 1))"), std::string::npos);
+	EXPECT_NE(source.find("precompiled(new ForStatementNode("), std::string::npos);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+TEST(Instrumentation, CountsLinesAndNodeKinds) {
+	Lexer lexer("test");
+	Parser parser;
+	parser.setTokens(lexer.index_tokens("1 + 2 * 3", 2));
+	auto ast = parser.parse();
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+
+	Instrumentation::reset();
+	Instrumentation::enabled = true;
+	interp->visit(ast->node, ctx);
+	Instrumentation::enabled = false;
+
+	EXPECT_EQ(Instrumentation::types[Node::Type::BINARY].hits, 2);
+	EXPECT_EQ(Instrumentation::types[Node::Type::NUMERIC].hits, 3);
+	ASSERT_EQ(Instrumentation::lines.size(), 3);
+	EXPECT_EQ(Instrumentation::lines[2].hits, 5);
+	EXPECT_TRUE(Instrumentation::children.empty());
+
+	Instrumentation::reset();
+}
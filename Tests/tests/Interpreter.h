@@ -90,3 +90,324 @@ TEST(Interpreter, VisitVariableAssignNode) {
 
 	EXPECT_EQ(value, -51.3);
 }
+
+TEST(Interpreter, VisitVariableAssignNodeAppendsInPlace) {
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+	ctx->symbols->set("s", SharedString(std::string(64, 'x')));
+
+	auto& text = std::get<SharedString>(ctx->symbols->get("s")->second);
+	text.reserve(256);
+	auto buffer = text.data();
+
+	for (auto line : { "var s = s + \"y\"", "var s = s + 1" }) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		auto node = parser.parse()->node;
+		Node::discard(node);
+
+		auto result = interp->visit(node, ctx);
+		EXPECT_EQ(result->error, nullptr);
+		EXPECT_EQ(result->value, nullptr);
+	}
+
+	auto& appended = std::get<SharedString>(ctx->symbols->get("s")->second);
+	EXPECT_EQ(appended.data(), buffer);
+	EXPECT_EQ(std::string(appended.data(), appended.size()), std::string(64, 'x') + "y1");
+}
+
+TEST(Interpreter, VisitPropertyAccessNodeCachesPath) {
+	MapStorage pool, db, cfg;
+	pool.set("size", new Number(8));
+	db.set("pool", new Map(pool));
+	cfg.set("db", new Map(db));
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	auto symbols = new Symbols();
+	symbols->set("cfg", cfg);
+	ctx->symbols = symbols;
+
+	Lexer lexer("test");
+	Parser parser;
+	parser.setTokens(lexer.index_tokens("cfg.db.pool.size"));
+	auto node = (PropertyAccessNode*)parser.parse()->node;
+
+	ASSERT_EQ(node->steps.size(), 3);
+
+	for (int i = 0; i < 2; i++) {
+		auto result = interp->visit_property_access_node(node, ctx);
+		EXPECT_EQ(std::get<int>(result->value->value), 8);
+	}
+
+	EXPECT_EQ(node->steps[2].shape, pool.shape());
+	EXPECT_EQ(node->steps[2].index, 0);
+}
+
+TEST(Interpreter, VisitAssignmentNodesMutateInPlace) {
+	ArrayStorage array(std::vector<Type*>{ new Number(1), new Number(2) });
+	MapStorage pool, cfg;
+	pool.set("size", new Number(8));
+	cfg.set("pool", new Map(pool));
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	auto symbols = new Symbols();
+	symbols->set("arr", array);
+	symbols->set("cfg", cfg);
+	ctx->symbols = symbols;
+
+	for (auto line : { "arr[1] = 5", "cfg.pool.size = 16", "cfg[\"name\"] = 1" }) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		auto result = interp->visit(parser.parse()->node, ctx);
+		EXPECT_EQ(result->error, nullptr);
+	}
+
+	EXPECT_EQ(array.kind(), ArrayStorage::Kind::INTS);
+	EXPECT_EQ(array.ints()[1], 5);
+	EXPECT_EQ(std::get<int>(pool.find("size")->value), 16);
+	EXPECT_EQ(cfg.entries().back().key, "name");
+}
+
+TEST(Interpreter, VisitForInStatementNodeReadsSourceInPlace) {
+	std::vector<int> ints(100);
+	for (int i = 0; i < 100; i++)
+		ints[i] = i;
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	auto symbols = new Symbols();
+	symbols->set("arr", ArrayStorage(std::move(ints)));
+	ctx->symbols = symbols;
+
+	Lexer lexer("test");
+	Parser parser;
+	parser.setTokens(lexer.index_tokens("for x in arr then 0"));
+	auto node = parser.parse()->node;
+
+	Allocations::reset();
+	interp->visit(node, ctx);
+
+	// One Number per visit of the `0` body, none for the elements.
+	EXPECT_EQ(Allocations::stats[Allocations::Phase::EVAL][Allocations::Kind::NUMBER].count, 100);
+	EXPECT_EQ(std::get<int>(symbols->get("x")->second), 99);
+
+	Range range(10, 0, -3);
+	EXPECT_EQ(range.size(), 4);
+	EXPECT_EQ(std::get<int>(range.at(3)->value), 1);
+}
+
+TEST(Interpreter, VisitYieldNodeSuspendsGenerator) {
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+
+	for (auto line : {
+		"function count() -> for i = 0 to 1000000 then yield i",
+		"var g = count()",
+		"for x in g then if x == 3 then undefined_name"
+	}) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		auto result = interp->visit(parser.parse()->node, ctx);
+
+		if (std::string(line).find("undefined_name") != std::string::npos)
+			EXPECT_NE(result->error, nullptr);
+		else
+			EXPECT_EQ(result->error, nullptr);
+	}
+
+	// The loop stopped after pulling four values, the body is suspended.
+	auto& range = std::get<Range>(ctx->symbols->get("g")->second);
+	EXPECT_EQ(range.kind(), Range::Kind::STREAM);
+	EXPECT_EQ(std::get<int>(range.stream()->value()->value), 3);
+	EXPECT_FALSE(range.stream()->done());
+
+	// Destroying a suspended coroutine unwinds its body.
+	{
+		int yielded = 0;
+		Coroutine coroutine([&yielded](Coroutine& self) -> Error* {
+			while (true) {
+				yielded++;
+				self.yield(nullptr);
+			}
+		});
+
+		EXPECT_TRUE(coroutine.resume());
+		EXPECT_TRUE(coroutine.resume());
+		EXPECT_EQ(yielded, 2);
+	}
+}
+
+TEST(Interpreter, VisitForStatementNodeRunsNativeOnceHot) {
+	if (!Jit::supported())
+		return;
+
+	Jit::enabled = true;
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+
+	std::vector<Node*> nodes;
+
+	for (auto line : {
+		"var acc = 0",
+		"for i = 0 to 100 then for j = 0 to 100 then var acc = acc + i * j - 1",
+		"function fib(n) -> if n < 2 then n else fib(n - 1) + fib(n - 2)",
+		"var result = fib(20)",
+		"var half = fib(1.5)"
+	}) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		nodes.push_back(parser.parse()->node);
+		EXPECT_EQ(interp->visit(nodes.back(), ctx)->error, nullptr);
+	}
+
+	EXPECT_EQ(std::get<int>(ctx->symbols->get("acc")->second), 24502500 - 10000);
+	EXPECT_EQ(std::get<int>(ctx->symbols->get("i")->second), 99);
+	EXPECT_EQ(std::get<int>(ctx->symbols->get("j")->second), 99);
+	EXPECT_EQ(std::get<int>(ctx->symbols->get("result")->second), 6765);
+	// A double argument fails the entry guard and is interpreted.
+	EXPECT_EQ(std::get<double>(ctx->symbols->get("half")->second), 1.5);
+
+	auto inner = (ForStatementNode*)((ForStatementNode*)nodes[1])->body;
+	EXPECT_NE(inner->hotness.code, nullptr);
+
+	auto fib = std::get<Function*>(ctx->symbols->get("fib")->second);
+	EXPECT_NE(fib->hotness.code, nullptr);
+	EXPECT_TRUE(fib->hotness.code->recursive);
+	EXPECT_EQ(fib->hotness.failures, 1u);
+}
+
+TEST(Interpreter, VisitBinaryOperationNodeQuickensOnInts) {
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+	ctx->symbols->set("a", 2);
+	ctx->symbols->set("xs", ArrayStorage());
+	std::get<ArrayStorage>(ctx->symbols->get("xs")->second).push(new Number(7));
+
+	auto parse = [](const char* line) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		return parser.parse()->node;
+	};
+
+	auto sum = (BinaryOperationNode*)parse("a * 3 + xs[a - 2]");
+	EXPECT_EQ(sum->quickening, Quickening::UNSEEN);
+
+	EXPECT_EQ(std::get<int>(interp->visit(sum, ctx)->value->value), 13);
+	EXPECT_EQ(sum->quickening, Quickening::INT);
+	EXPECT_EQ(((IndexAccessNode*)sum->right)->quickening, Quickening::INT);
+	// Quickened nodes take the unboxed path from now on.
+	EXPECT_EQ(std::get<int>(interp->visit(sum, ctx)->value->value), 13);
+
+	// A double operand fails the guard, the site becomes generic for good.
+	ctx->symbols->set("a", 2.5);
+	auto product = (BinaryOperationNode*)sum->left;
+	EXPECT_EQ(std::get<double>(interp->visit(product, ctx)->value->value), 7.5);
+	EXPECT_EQ(product->quickening, Quickening::GENERIC);
+
+	ctx->symbols->set("a", 2);
+	EXPECT_EQ(std::get<int>(interp->visit(sum, ctx)->value->value), 13);
+	EXPECT_EQ(product->quickening, Quickening::GENERIC);
+}
+
+TEST(Interpreter, VisitFunctionDefinitionNodeCapturesLexically) {
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+
+	std::vector<Node*> nodes;
+
+	for (auto line : {
+		"function adder(n) -> function(x) -> x + n",
+		"var add5 = adder(5)",
+		"var add7 = adder(7)",
+		"var a = add5(1)",
+		"var b = add7(1)",
+		"function leak() -> secret",
+		"function caller(secret) -> leak()"
+	}) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		nodes.push_back(parser.parse()->node);
+		EXPECT_EQ(interp->visit(nodes.back(), ctx)->error, nullptr);
+	}
+
+	EXPECT_EQ(std::get<int>(ctx->symbols->get("a")->second), 6);
+	EXPECT_EQ(std::get<int>(ctx->symbols->get("b")->second), 8);
+
+	// The inner function reads `n` from its first closure slot.
+	auto inner = (FunctionDefinitionNode*)((FunctionDefinitionNode*)nodes[0])->body;
+	ASSERT_EQ(inner->captures.size(), 1u);
+	EXPECT_EQ(inner->captures[0], "n");
+	EXPECT_EQ(((VariableAccessNode*)inner->body->right)->capture, 0);
+
+	// Free names no longer resolve through the caller's scope.
+	Lexer lexer("test");
+	Parser parser;
+	parser.setTokens(lexer.index_tokens("caller(1)"));
+	EXPECT_NE(interp->visit(parser.parse()->node, ctx)->error, nullptr);
+}
+
+TEST(Interpreter, VisitFunctionCallNodeCachesCallee) {
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+
+	auto parse = [](const char* line) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		return parser.parse()->node;
+	};
+
+	interp->visit(parse("function f(x) -> x + 1"), ctx);
+
+	auto call = (FunctionCallNode*)parse("f(1)");
+	EXPECT_EQ(std::get<int>(interp->visit(call, ctx)->value->value), 2);
+	EXPECT_NE(call->cache.function, nullptr);
+	EXPECT_EQ(call->cache.arity, 1u);
+	EXPECT_EQ(std::get<int>(interp->visit(call, ctx)->value->value), 2);
+
+	// Rebinding the name invalidates the cached callee.
+	auto version = Symbols::version;
+	interp->visit(parse("function f(x) -> x * 10"), ctx);
+	EXPECT_NE(Symbols::version, version);
+	EXPECT_EQ(std::get<int>(interp->visit(call, ctx)->value->value), 10);
+	EXPECT_EQ(call->cache.function, std::get<Function*>(ctx->symbols->get("f")->second));
+
+	// So does a scope binding a function being dropped.
+	version = Symbols::version;
+	auto scope = new Symbols(ctx->symbols);
+	scope->set("f", std::get<Function*>(ctx->symbols->get("f")->second));
+	delete scope;
+	EXPECT_GT(Symbols::version, version + 1);
+
+	// And a local value hiding the function from inside a loop body.
+	ctx->symbols->resolver = [](const std::string& name, DynamicType& value) {
+		auto fn = NativeFunction::create(name);
+
+		if (fn != nullptr)
+			value = (Function*)fn;
+
+		return fn != nullptr;
+	};
+
+	interp->visit(parse("var out = []"), ctx);
+	interp->visit(parse("function k() -> for i = 0 to 2 then [push(out, f(i)), var f = 5]"), ctx);
+	auto shadowed = interp->visit(parse("k()"), ctx);
+	ASSERT_NE(shadowed->error, nullptr);
+	EXPECT_NE(shadowed->error->details.find("Expected a function"), std::string::npos);
+	EXPECT_EQ(std::get<ArrayStorage>(ctx->symbols->get("out")->second).size(), 1u);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+TEST(Metrics, RenderCountersAndHistograms) {
+	Metrics::counter("test_calls_total", "Calls.", "name", "f") += 2;
+	Metrics::histogram("test_duration_seconds", "Durations.").observe(0.005);
+
+	auto text = Metrics::render(Metrics::Format::PROMETHEUS);
+
+	EXPECT_NE(text.find("# TYPE test_calls_total counter"), std::string::npos);
+	EXPECT_NE(text.find("test_calls_total{name=\"f\"} 2"), std::string::npos);
+	EXPECT_NE(text.find("test_duration_seconds_bucket{le=\"0.001\"} 0"), std::string::npos);
+	EXPECT_NE(text.find("test_duration_seconds_bucket{le=\"0.01\"} 1"), std::string::npos);
+	EXPECT_NE(text.find("test_duration_seconds_count 1"), std::string::npos);
+
+	auto json = Metrics::render(Metrics::Format::JSON);
+	EXPECT_NE(json.find("\"name\": \"test_calls_total\""), std::string::npos);
+
+	Metrics::reset();
+	EXPECT_EQ(Metrics::counter("test_calls_total", "Calls.", "name", "f"), 0);
+}
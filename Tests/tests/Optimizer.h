@@ -0,0 +1,96 @@
+#pragma once
+
+static std::vector<Node*> parse_program(const std::vector<const char*>& lines)
+{
+	std::vector<Node*> program;
+
+	for (auto line : lines) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		program.push_back(parser.parse()->node);
+	}
+
+	return program;
+}
+
+TEST(Optimizer, InlinesSmallFunctionsWithStableBindings) {
+	auto program = parse_program({
+		"function sq(x) -> x * x",
+		"function fact(n) -> if n < 2 then 1 else n * fact(n - 1)",
+		"var a = 3",
+		"var b = sq(a) + sq(2) + fact(4)",
+		"function scaled(y) -> sq(y) + a",
+		"function shadow(a) -> scaled(a)"
+	});
+
+	Optimizer optimizer;
+	EXPECT_TRUE(optimizer.optimize(program));
+
+	// Both sq calls and the one in scaled, but not the recursive fact, nor
+	// scaled where its global `a` is a parameter.
+	EXPECT_EQ(optimizer.changes("inline"), 3u);
+
+	auto sum = program[3]->left;
+	EXPECT_EQ(sum->left->left->type, Node::Type::BINARY);
+	EXPECT_EQ(sum->right->type, Node::Type::FN_CALL);
+	EXPECT_EQ(((FunctionDefinitionNode*)program[5])->body->type, Node::Type::FN_CALL);
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+
+	for (auto node : program)
+		EXPECT_EQ(interp->visit(node, ctx)->error, nullptr);
+
+	EXPECT_EQ(std::get<int>(ctx->symbols->get("b")->second), 9 + 4 + 24);
+}
+
+TEST(Optimizer, HoistsInvariantsAndReducesInductionProducts) {
+	auto program = parse_program({
+		"var k = 3",
+		"var s = 0",
+		"var xs = [1, 2, 3]",
+		"for i = 0 to 10 then var s = s + k * 2 + sqrt(16) + i * 4",
+		"var n = 0",
+		"while n < 5 then var n = n + xs[1] * k",
+		"for i = 0 to 4 then push(xs, sum(xs))",
+		"var t = 0",
+		"for i = 10 to 0 step -2 then var t = t + i * 3"
+	});
+
+	Optimizer optimizer;
+	EXPECT_TRUE(optimizer.optimize(program));
+
+	// sum(xs) reads the array push changes, it stays in its loop.
+	EXPECT_EQ(optimizer.changes("hoist"), 3u);
+	EXPECT_EQ(optimizer.changes("reduce"), 2u);
+	EXPECT_EQ(((ForStatementNode*)program[3])->invariants.size(), 2u);
+	EXPECT_EQ(((ForStatementNode*)program[3])->inductions.size(), 1u);
+	EXPECT_TRUE(((ForStatementNode*)program[6])->invariants.empty());
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+	ctx->symbols->resolver = [](const std::string& name, DynamicType& value) {
+		auto fn = NativeFunction::create(name);
+
+		if (fn != nullptr)
+			value = (Function*)fn;
+
+		return fn != nullptr;
+	};
+
+	for (auto node : program)
+		EXPECT_EQ(interp->visit(node, ctx)->error, nullptr);
+
+	EXPECT_EQ(std::get<double>(ctx->symbols->get("s")->second), 280.0);
+	EXPECT_EQ(std::get<int>(ctx->symbols->get("n")->second), 6);
+	EXPECT_EQ(std::get<int>(ctx->symbols->get("t")->second), 90);
+
+	// A value no loop places is reported.
+	EXPECT_TRUE(optimizer.verify(program));
+	((ForStatementNode*)program[6])->invariants.push_back(new InvariantNode(new NumericNode(new Token(Token::Type::INT, 1))));
+	EXPECT_FALSE(optimizer.verify(program));
+	EXPECT_FALSE(optimizer.error.empty());
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+TEST(Profiler, ScopesAggregateByName) {
+	Profiler::reset();
+	Profiler::enabled = true;
+
+	for (int i = 0; i < 3; ++i) {
+		Profiler::Scope scope("work", "function");
+	}
+
+	Profiler::enabled = false;
+
+	{
+		Profiler::Scope scope("ignored");
+	}
+
+	ASSERT_EQ(Profiler::stats.count("work"), 1);
+	EXPECT_EQ(Profiler::stats.count("ignored"), 0);
+	EXPECT_EQ(Profiler::stats["work"].count, 3);
+	EXPECT_GE(Profiler::stats["work"].max, Profiler::stats["work"].min);
+	EXPECT_TRUE(Profiler::events.empty());
+}
+
+TEST(Profiler, WriteTraceEvents) {
+	Profiler::reset();
+	Profiler::enabled = true;
+	Profiler::tracing = true;
+
+	{
+		Profiler::Scope scope("eval");
+	}
+
+	Profiler::enabled = false;
+	Profiler::tracing = false;
+
+	auto path = (std::filesystem::temp_directory_path() / "birdlang-trace.json").string();
+	ASSERT_TRUE(Profiler::writeTrace(path));
+
+	std::ifstream stream(path);
+	std::string trace((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+	EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+	EXPECT_NE(trace.find("\"name\":\"eval\""), std::string::npos);
+	EXPECT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+
+	Profiler::reset();
+}
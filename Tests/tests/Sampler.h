@@ -0,0 +1,20 @@
+#pragma once
+
+TEST(Sampler, CollapsesCallStacks) {
+	Sampler::reset();
+	Sampler::start(std::chrono::milliseconds(100));
+
+	{
+		Sampler::Call call("f", 0);
+		Sampler::ticks = 2;
+		Sampler::sample(4);
+	}
+
+	Sampler::stop();
+
+	EXPECT_EQ(Sampler::samples["<program>:1;f:5"], 2);
+	EXPECT_EQ(Sampler::total, 2);
+	EXPECT_EQ(Sampler::frames.size(), 1);
+
+	Sampler::reset();
+}
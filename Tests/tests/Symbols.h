@@ -17,4 +17,22 @@ TEST(Symbols, GetSymbol) {
 	Symbols symbols;
 	symbols.set("test", 2);
 	EXPECT_EQ(std::get<int>(symbols.get("test")->second), 2);
-}
\ No newline at end of file
+}
+
+TEST(Symbols, ResolveSymbolOnFirstLookup) {
+	Symbols globals;
+	int calls = 0;
+	globals.resolver = [&calls](const std::string& name, DynamicType& value) {
+		calls++;
+		if (name != "answer")
+			return false;
+		value = 42;
+		return true;
+	};
+
+	Symbols locals(&globals);
+	EXPECT_EQ(std::get<int>(locals.get("answer")->second), 42);
+	EXPECT_EQ(std::get<int>(locals.get("answer")->second), 42);
+	EXPECT_EQ(calls, 1);
+	EXPECT_TRUE(locals.get("missing") == globals.symbols.end());
+}
@@ -42,3 +42,154 @@ TEST(Number, OperationPower) {
 	auto r = a.power(&b);
 	EXPECT_EQ(std::get<double>(r.first->value), 1296);
 }
+
+TEST(String, SharesLongTextBetweenCopies) {
+	SharedString small("short");
+	EXPECT_TRUE(small.isInline());
+
+	SharedString text(std::string(64, 'x'));
+	SharedString copy = text;
+	EXPECT_FALSE(text.isInline());
+	EXPECT_EQ(text.data(), copy.data());
+	EXPECT_EQ(text.references(), 2);
+
+	copy.append("y");
+	EXPECT_NE(text.data(), copy.data());
+	EXPECT_EQ(text.size(), 64);
+	EXPECT_EQ(copy.size(), 65);
+	EXPECT_EQ(text.references(), 1);
+}
+
+TEST(String, InternsLiterals) {
+	Lexer lexer("test");
+	Parser parser;
+	parser.setTokens(lexer.index_tokens("\"an interned literal longer than inline\""));
+	auto a = (StringNode*)parser.parse()->node;
+
+	parser.setTokens(lexer.index_tokens("\"an interned literal longer than inline\""));
+	auto b = (StringNode*)parser.parse()->node;
+
+	EXPECT_EQ(a->value.data(), b->value.data());
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+	auto value = interp->visit(a, ctx)->value;
+
+	EXPECT_EQ(std::get<SharedString>(value->value).data(), a->value.data());
+}
+
+TEST(String, JoinsFormattedElements) {
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+	ctx->symbols->set("separator", SharedString(", "));
+
+	ctx->symbols->set("array", ArrayStorage(std::vector<Type*>{ new Number(1), new String(SharedString("two")), new Number(true) }));
+	auto mixed = NativeFunction::fn_join(ctx);
+	EXPECT_EQ(mixed->error, nullptr);
+	EXPECT_EQ(std::get<SharedString>(mixed->value->value), SharedString("1, two, true"));
+
+	ctx->symbols->set("array", ArrayStorage(std::vector<Type*>{}));
+	auto empty = NativeFunction::fn_join(ctx);
+	EXPECT_EQ(empty->error, nullptr);
+	EXPECT_EQ(std::get<SharedString>(empty->value->value).size(), 0u);
+}
+
+TEST(Array, MutatesSharedStorageInPlace) {
+	Array array(std::vector<Type*>{ new Number(1) });
+	Array alias(array.value);
+
+	Number two(2);
+	alias.compare_less_than(&two);
+	alias.add(&alias);
+
+	EXPECT_TRUE(std::get<ArrayStorage>(array.value).shares(std::get<ArrayStorage>(alias.value)));
+	EXPECT_EQ(std::get<ArrayStorage>(array.value).size(), 4);
+
+	Number first(0);
+	array.subtract(&first);
+	EXPECT_EQ(std::get<ArrayStorage>(alias.value).size(), 3);
+}
+
+TEST(Array, PacksNumbersUntilMixed) {
+	ArrayStorage storage;
+	storage.push(new Number(1));
+	storage.push(new Number(2));
+	EXPECT_EQ(storage.kind(), ArrayStorage::Kind::INTS);
+	EXPECT_EQ(Kernels::sum(storage.ints().data(), storage.size()), 3);
+
+	storage.push(new Number(2.5));
+	EXPECT_EQ(storage.kind(), ArrayStorage::Kind::BOXED);
+	EXPECT_EQ(std::get<int>(storage.at(1)->value), 2);
+	EXPECT_EQ(std::get<double>(storage.at(2)->value), 2.5);
+
+	std::vector<double> values = { 1, 2, 3, 4, 5, 6, 7 };
+	EXPECT_EQ(Kernels::sum(values.data(), values.size()), 28);
+	EXPECT_EQ(Kernels::max(values.data(), values.size()), 7);
+	EXPECT_EQ(Kernels::dot(values.data(), values.data(), values.size()), 140);
+}
+
+TEST(Array, ElementwisePromotesOnOverflow) {
+	std::vector<int> a = { 1, 2, 3, 4, 2147483647 }, out(a.size());
+	EXPECT_TRUE(Kernels::apply(Kernels::ADD, a.data(), nullptr, -1, out.data(), a.size()));
+	EXPECT_EQ(out[4], 2147483646);
+	EXPECT_FALSE(Kernels::apply(Kernels::ADD, a.data(), nullptr, 1, out.data(), a.size()));
+	EXPECT_FALSE(Kernels::apply(Kernels::SUBTRACT, a.data(), nullptr, -2147483647 - 1, out.data(), a.size()));
+
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+	ctx->symbols->set("a", ArrayStorage(std::vector<int>{ 100000, 3 }));
+	ctx->symbols->set("b", 100000);
+
+	auto result = NativeFunction::fn_vmul(ctx);
+	EXPECT_EQ(result->error, nullptr);
+
+	auto& product = std::get<ArrayStorage>(result->value->value);
+	EXPECT_EQ(product.kind(), ArrayStorage::Kind::DOUBLES);
+	EXPECT_EQ(product.doubles()[0], 1e10);
+	EXPECT_EQ(product.doubles()[1], 3e5);
+}
+
+TEST(Map, KeepsInsertionOrderAndFindsKeys) {
+	MapStorage map;
+	Number one(1), two(2), three(3);
+
+	for (int i = 0; i < 100; i++)
+		map.set("key" + std::to_string(i), &one);
+
+	map.set("zeta", &two);
+	map.set("alpha", &three);
+	map.set("key0", &two);
+
+	EXPECT_EQ(map.size(), 102);
+	EXPECT_EQ(map.entries().front().key, "key0");
+	EXPECT_EQ(map.entries().back().key, "alpha");
+	EXPECT_EQ(map.find("key0"), &two);
+	EXPECT_EQ(map.find("alpha", MapStorage::hash("alpha")), &three);
+	EXPECT_EQ(map.find("missing"), nullptr);
+}
+
+TEST(Range, PrintsThroughDescribe) {
+	ArrayStorage array(std::vector<int>{ 1, 2 });
+	std::ostringstream keys, values;
+
+	keys << Type::from(Range(Range::Kind::KEYS, array));
+	values << Type::from(Range(Range::Kind::VALUES, array));
+	EXPECT_EQ(keys.str(), "keys(<array>)");
+	EXPECT_EQ(values.str(), "values(<array>)");
+
+	auto interp = new Interpreter();
+	auto ctx = new Context("<test>");
+	ctx->symbols = new Symbols();
+
+	for (auto line : { "function g() -> yield 1", "var stream = g()" }) {
+		Lexer lexer("test");
+		Parser parser;
+		parser.setTokens(lexer.index_tokens(line));
+		EXPECT_EQ(interp->visit(parser.parse()->node, ctx)->error, nullptr);
+	}
+
+	std::ostringstream generator;
+	generator << Type::from(ctx->symbols->get("stream")->second);
+	EXPECT_EQ(generator.str(), "<generator>");
+}
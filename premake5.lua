@@ -133,6 +133,11 @@ project "Interpreter"
 			"PLATFORM_LINUX"
 		}
 
+		links
+		{
+			"pthread"
+		}
+
 	filter "configurations:Debug"
 		defines {
 			"DEBUG",
@@ -146,6 +151,69 @@ project "Interpreter"
 		optimize "On"
 		kind "ConsoleApp"
         
+project "Benchmarks"
+	location "Benchmarks"
+
+	language "C++"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs
+	{
+		"Compiler/include",
+		"Compiler/src",
+	}
+
+	links
+	{
+		"Compiler"
+	}
+
+	filter "system:windows"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+		defines
+		{
+			"PLATFORM_WINDOWS"
+		}
+
+	filter "system:linux"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+		defines
+		{
+			"PLATFORM_LINUX"
+		}
+
+		links
+		{
+			"pthread"
+		}
+
+	filter "configurations:Debug"
+		defines {
+			"DEBUG",
+			'_ITERATOR_DEBUG_LEVEL=0'
+		}
+		kind "ConsoleApp"
+		symbols "On"
+		
+	filter "configurations:Release"
+		defines "RELEASE"
+		optimize "On"
+		kind "ConsoleApp"
+
 project "Tests"
 	location "Tests"
 	language "C++"